@@ -1,17 +1,22 @@
 Name:       nemo-qml-plugin-thumbnailer-qt5
 Summary:    Thumbnail provider plugin for Nemo Mobile
-Version:    1.0.7
+Version:    2.0.0
 Release:    1
 License:    BSD
 URL:        https://github.com/sailfishos/nemo-qml-plugin-thumbnailer
 Source0:    %{name}-%{version}.tar.bz2
 BuildRequires:  pkgconfig(Qt5Core)
 BuildRequires:  pkgconfig(Qt5Gui)
+BuildRequires:  pkgconfig(Qt5Network)
 BuildRequires:  pkgconfig(Qt5Qml)
 BuildRequires:  pkgconfig(Qt5Quick)
+BuildRequires:  pkgconfig(Qt5Test)
 BuildRequires:  pkgconfig(mlite5)
+BuildRequires:  pkgconfig(libjpeg)
+BuildRequires:  pkgconfig(libturbojpeg)
 BuildRequires:  sailfish-qdoc-template
-Requires: thumbnaild
+# Strips need the frame count option of thumbnaild-video.
+Requires: thumbnaild >= 1.1.0
 Provides: nemo-qml-plugin-thumbnailer-qt5-video
 
 %description
@@ -24,6 +29,34 @@ Requires:   %{name} = %{version}-%{release}
 %description devel
 %{summary}.
 
+%package daemon
+Summary:    Out-of-process thumbnail generation daemon
+Requires:   %{name} = %{version}-%{release}
+
+%description daemon
+%{summary}.
+
+%package indexer
+Summary:    Background thumbnail pre-generation
+Requires:   %{name} = %{version}-%{release}
+
+%description indexer
+%{summary}.
+
+%package tools
+Summary:    Thumbnail cache command line tools
+Requires:   %{name} = %{version}-%{release}
+
+%description tools
+%{summary}.
+
+%package tests
+Summary:    Thumbnailer benchmarks
+Requires:   %{name} = %{version}-%{release}
+
+%description tests
+%{summary}.
+
 %package doc
 Summary:    Thumbnailer plugin documentation
 
@@ -40,11 +73,19 @@ Summary:    Thumbnailer plugin documentation
 %install
 %qmake5_install
 
+# Thumbnail generator plugins
+mkdir -p %{buildroot}%{_libdir}/qt5/qml/Nemo/Thumbnailer/thumbnailers
+
 # org.nemomobile.thumbnailer legacy import
 mkdir -p %{buildroot}%{_libdir}/qt5/qml/org/nemomobile/thumbnailer/
 ln -sf %{_libdir}/qt5/qml/Nemo/Thumbnailer/libnemothumbnailer.so %{buildroot}%{_libdir}/qt5/qml/org/nemomobile/thumbnailer/
 sed 's/Nemo.Thumbnailer/org.nemomobile.thumbnailer/' < src/plugin/qmldir > %{buildroot}%{_libdir}/qt5/qml/org/nemomobile/thumbnailer/qmldir
 
+mkdir -p %{buildroot}%{_userunitdir}/user-session.target.wants
+ln -s ../nemo-thumbnailer-daemon.service %{buildroot}%{_userunitdir}/user-session.target.wants/
+ln -s ../nemo-thumbnailer-indexer.timer %{buildroot}%{_userunitdir}/user-session.target.wants/
+ln -s ../nemo-thumbnailer-maintenance.timer %{buildroot}%{_userunitdir}/user-session.target.wants/
+
 %post -p /sbin/ldconfig
 
 %postun -p /sbin/ldconfig
@@ -56,6 +97,8 @@ sed 's/Nemo.Thumbnailer/org.nemomobile.thumbnailer/' < src/plugin/qmldir > %{bui
 %{_libdir}/qt5/qml/Nemo/Thumbnailer/libnemothumbnailer.so
 %{_libdir}/qt5/qml/Nemo/Thumbnailer/qmldir
 %{_libdir}/qt5/qml/Nemo/Thumbnailer/plugins.qmltypes
+%dir %{_libdir}/qt5/qml/Nemo/Thumbnailer/thumbnailers
+%{_libdir}/qt5/plugins/imageformats/libnemoqoi.so
 
 # org.nemomobile.thumbnailer legacy import
 %dir %{_libdir}/qt5/qml/org/nemomobile/thumbnailer
@@ -68,6 +111,27 @@ sed 's/Nemo.Thumbnailer/org.nemomobile.thumbnailer/' < src/plugin/qmldir > %{bui
 %{_includedir}/nemothumbnailer-qt5/*.h
 %{_libdir}/pkgconfig/nemothumbnailer-qt5.pc
 
+%files daemon
+%{_bindir}/nemo-thumbnailer-daemon
+%{_userunitdir}/nemo-thumbnailer-daemon.service
+%{_userunitdir}/user-session.target.wants/nemo-thumbnailer-daemon.service
+
+%files indexer
+%{_bindir}/nemo-thumbnailer-indexer
+%{_userunitdir}/nemo-thumbnailer-indexer.service
+%{_userunitdir}/nemo-thumbnailer-indexer.timer
+%{_userunitdir}/user-session.target.wants/nemo-thumbnailer-indexer.timer
+
+%files tools
+%{_bindir}/nemo-thumbnailer-warm
+%{_bindir}/nemo-thumbnailer-cache
+%{_userunitdir}/nemo-thumbnailer-maintenance.service
+%{_userunitdir}/nemo-thumbnailer-maintenance.timer
+%{_userunitdir}/user-session.target.wants/nemo-thumbnailer-maintenance.timer
+
+%files tests
+/opt/tests/nemo-qml-plugin-thumbnailer-qt5
+
 %files doc
 %dir %{_datadir}/doc/nemo-qml-plugin-thumbnailer
 %{_datadir}/doc/nemo-qml-plugin-thumbnailer/nemo-qml-plugin-thumbnailer.qch
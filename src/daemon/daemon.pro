@@ -0,0 +1,23 @@
+TEMPLATE = app
+TARGET = nemo-thumbnailer-daemon
+
+CONFIG += c++17
+QT += network
+
+INCLUDEPATH += ../lib
+LIBS += -L../lib -lnemothumbnailer-qt$${QT_MAJOR_VERSION}
+
+SOURCES += \
+    main.cpp \
+    nemothumbnaildaemon.cpp \
+    nemothumbnailwatcher.cpp
+HEADERS += \
+    nemothumbnaildaemon.h \
+    nemothumbnailwatcher.h
+
+target.path = /usr/bin
+
+service.files = nemo-thumbnailer-daemon.service
+service.path = /usr/lib/systemd/user
+
+INSTALLS += target service
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QScopedPointer>
+#include <QSocketNotifier>
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "nemothumbnaildaemon.h"
+#include "nemothumbnailwatcher.h"
+
+namespace {
+
+int signalSockets[2] = { -1, -1 };
+
+void handleTerminate(int)
+{
+    const char byte = 0;
+    if (::write(signalSockets[0], &byte, 1) < 0) {
+        // Nothing can be done from a signal handler.
+    }
+}
+
+// Quits the event loop on SIGTERM and SIGINT so the watcher can save its state.
+void quitOnTerminate(QCoreApplication *app)
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, signalSockets) != 0) {
+        return;
+    }
+
+    QSocketNotifier *notifier = new QSocketNotifier(signalSockets[1], QSocketNotifier::Read, app);
+    QObject::connect(notifier, &QSocketNotifier::activated, app, &QCoreApplication::quit);
+
+    struct sigaction action = {};
+    action.sa_handler = handleTerminate;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    ::sigaction(SIGTERM, &action, nullptr);
+    ::sigaction(SIGINT, &action, nullptr);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    // The daemon generates in-process, it must never try to delegate to itself.
+    qputenv("NEMO_THUMBNAILER_DAEMON", "0");
+
+    QCoreApplication app(argc, argv);
+
+    NemoThumbnailDaemon daemon;
+    if (!daemon.listen(NemoThumbnailProtocol::socketPath())) {
+        return EXIT_FAILURE;
+    }
+
+    // Optionally keep the entries of files in a colon separated list of directories in sync
+    // with their sources.
+    QScopedPointer<NemoThumbnailWatcher> watcher;
+    const QByteArray watchedDirectories = qgetenv("NEMO_THUMBNAILER_WATCH");
+    if (!watchedDirectories.isEmpty()) {
+        watcher.reset(new NemoThumbnailWatcher(
+                          NemoThumbnailProtocol::cachePath(),
+                          QFile::decodeName(watchedDirectories).split(QLatin1Char(':'), QString::SkipEmptyParts)));
+        if (!watcher->start()) {
+            watcher.reset();
+        }
+    }
+
+    quitOnTerminate(&app);
+
+    return app.exec();
+}
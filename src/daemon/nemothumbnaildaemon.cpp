@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemothumbnaildaemon.h"
+
+#include <nemothumbnailcache.h>
+
+#include <QDebug>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QRunnable>
+
+namespace {
+
+const int MaximumSaneSize = 6000;
+
+class DaemonThumbnailCache : public NemoThumbnailCache
+{
+public:
+    DaemonThumbnailCache()
+        : NemoThumbnailCache(NemoThumbnailProtocol::cachePath())
+    {
+    }
+
+    ThumbnailData generate(const QString &path, const QByteArray &key, int size, bool crop,
+                           const QString &mimeType)
+    {
+        const ThumbnailData thumbnail = generateThumbnail(path, key, size, crop, mimeType);
+
+        // Clients read the entry from disk so it has to be written before replying.
+        return thumbnail.validPath() && waitForCacheFile(thumbnail.path())
+                ? thumbnail
+                : ThumbnailData();
+    }
+};
+
+Q_GLOBAL_STATIC(DaemonThumbnailCache, cache)
+
+class GenerateTask : public QRunnable
+{
+public:
+    GenerateTask(QObject *daemon, const QString &path, const QByteArray &key, int size, bool crop,
+                 const QString &mimeType)
+        : m_daemon(daemon)
+        , m_path(path)
+        , m_key(key)
+        , m_mimeType(mimeType)
+        , m_size(size)
+        , m_crop(crop)
+    {
+    }
+
+    void run() override
+    {
+        const NemoThumbnailCache::ThumbnailData thumbnail
+                = cache->generate(m_path, m_key, m_size, m_crop, m_mimeType);
+
+        QMetaObject::invokeMethod(m_daemon, "generationFinished", Qt::QueuedConnection,
+                                  Q_ARG(QByteArray, m_key),
+                                  Q_ARG(bool, thumbnail.validPath()),
+                                  Q_ARG(QString, thumbnail.path()));
+    }
+
+private:
+    QObject * const m_daemon;
+    const QString m_path;
+    const QByteArray m_key;
+    const QString m_mimeType;
+    const int m_size;
+    const bool m_crop;
+};
+
+bool validKey(const QByteArray &key, const QString &path, int size, bool crop)
+{
+    // Keys are used to build file paths, never accept anything but what cacheKey() produces for
+    // the requested source so a client can't store a thumbnail under another file's key.
+    return key == NemoThumbnailProtocol::sourceHash(path)
+            + '-' + QByteArray::number(size) + (crop ? "" : "F");
+}
+
+}
+
+NemoThumbnailDaemon::NemoThumbnailDaemon(QObject *parent)
+    : QObject(parent)
+    , m_server(new QLocalServer(this))
+    , m_running(0)
+{
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &NemoThumbnailDaemon::newConnection);
+}
+
+NemoThumbnailDaemon::~NemoThumbnailDaemon()
+{
+    m_server->close();
+    m_pool.clear();
+    m_pool.waitForDone();
+
+    qDeleteAll(m_jobs);
+    qDeleteAll(m_clients);
+}
+
+bool NemoThumbnailDaemon::listen(const QString &socketPath)
+{
+    // Refuse to take over the socket of a running daemon, but clean up after one that crashed.
+    QLocalSocket probe;
+    probe.connectToServer(socketPath);
+    if (probe.waitForConnected(100)) {
+        qWarning() << "Thumbnail daemon is already running on" << socketPath;
+        return false;
+    }
+
+    QLocalServer::removeServer(socketPath);
+    if (!m_server->listen(socketPath)) {
+        qWarning() << "Unable to listen on" << socketPath << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+void NemoThumbnailDaemon::newConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        Client *client = new Client;
+        client->socket = socket;
+        client->priority = NemoThumbnailCache::NormalPriority;
+        m_clients.insert(socket, client);
+
+        connect(socket, &QLocalSocket::readyRead, this, &NemoThumbnailDaemon::readClient);
+        connect(socket, &QLocalSocket::disconnected, this, &NemoThumbnailDaemon::clientDisconnected);
+    }
+}
+
+void NemoThumbnailDaemon::readClient()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    Client *client = m_clients.value(socket);
+    if (!client) {
+        return;
+    }
+
+    client->buffer.append(socket->readAll());
+
+    QByteArray payload;
+    for (;;) {
+        switch (NemoThumbnailProtocol::takeMessage(&client->buffer, &payload)) {
+        case NemoThumbnailProtocol::Taken:
+            if (processMessage(client, payload)) {
+                continue;
+            }
+            Q_FALLTHROUGH();
+        case NemoThumbnailProtocol::Invalid:
+            qWarning() << "Disconnecting misbehaving thumbnail client";
+            socket->disconnectFromServer();
+            return;
+        case NemoThumbnailProtocol::Incomplete:
+            schedule();
+            return;
+        }
+    }
+}
+
+void NemoThumbnailDaemon::clientDisconnected()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    Client *client = m_clients.take(socket);
+    if (!client) {
+        return;
+    }
+
+    // Drop the client's interest in pending jobs, jobs nobody waits for any more are cancelled
+    // unless they are already being generated.
+    QHash<QByteArray, Job *>::iterator it = m_jobs.begin();
+    while (it != m_jobs.end()) {
+        Job *job = *it;
+        for (int i = job->waiters.count() - 1; i >= 0; --i) {
+            if (job->waiters.at(i).client == client) {
+                job->waiters.remove(i);
+            }
+        }
+
+        if (job->waiters.isEmpty() && !job->running) {
+            m_queues[job->priority].removeOne(job);
+            delete job;
+            it = m_jobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    delete client;
+    socket->deleteLater();
+}
+
+bool NemoThumbnailDaemon::processMessage(Client *client, const QByteArray &payload)
+{
+    QDataStream stream(payload);
+    stream.setVersion(NemoThumbnailProtocol::streamVersion());
+
+    quint8 type = 0;
+    stream >> type;
+
+    switch (type) {
+    case NemoThumbnailProtocol::Hello: {
+        quint32 version = 0;
+        qint32 priority = 0;
+        stream >> version >> priority;
+
+        if (stream.status() != QDataStream::Ok || version != NemoThumbnailProtocol::Version) {
+            return false;
+        }
+        client->priority = qBound<int>(NemoThumbnailCache::HighPriority, priority,
+                                       NemoThumbnailCache::LowPriority);
+        return true;
+    }
+    case NemoThumbnailProtocol::Request: {
+        quint32 id = 0;
+        QString path;
+        QByteArray key;
+        qint32 size = 0;
+        bool crop = false;
+        QString mimeType;
+        stream >> id >> path >> key >> size >> crop >> mimeType;
+
+        if (stream.status() != QDataStream::Ok
+                || path.isEmpty()
+                || size <= 0 || size > MaximumSaneSize
+                || !validKey(key, path, size, crop)) {
+            return false;
+        }
+        request(client, id, path, key, size, crop, mimeType);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void NemoThumbnailDaemon::request(
+        Client *client, quint32 id, const QString &path, const QByteArray &key, int size, bool crop,
+        const QString &mimeType)
+{
+    Job *job = m_jobs.value(key);
+    if (!job) {
+        job = new Job;
+        job->path = path;
+        job->key = key;
+        job->mimeType = mimeType;
+        job->size = size;
+        job->priority = client->priority;
+        job->crop = crop;
+        job->running = false;
+
+        m_jobs.insert(key, job);
+        m_queues[job->priority].append(job);
+    } else if (!job->running && client->priority < job->priority) {
+        // Another client is already waiting on this key, promote it to the more urgent queue.
+        m_queues[job->priority].removeOne(job);
+        job->priority = client->priority;
+        m_queues[job->priority].append(job);
+    }
+
+    job->waiters.append({ client, id });
+}
+
+void NemoThumbnailDaemon::schedule()
+{
+    for (int priority = 0; priority < NemoThumbnailProtocol::PriorityCount; ++priority) {
+        while (m_running < m_pool.maxThreadCount() && !m_queues[priority].isEmpty()) {
+            Job *job = m_queues[priority].takeFirst();
+            job->running = true;
+            ++m_running;
+
+            m_pool.start(new GenerateTask(this, job->path, job->key, job->size, job->crop, job->mimeType));
+        }
+    }
+}
+
+void NemoThumbnailDaemon::generationFinished(const QByteArray &key, bool ok, const QString &thumbnailPath)
+{
+    --m_running;
+
+    if (Job *job = m_jobs.take(key)) {
+        for (const Waiter &waiter : job->waiters) {
+            sendCompleted(waiter.client, waiter.id, key, ok, thumbnailPath);
+        }
+        delete job;
+    }
+
+    schedule();
+}
+
+void NemoThumbnailDaemon::sendCompleted(
+        Client *client, quint32 id, const QByteArray &key, bool ok, const QString &thumbnailPath)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(NemoThumbnailProtocol::streamVersion());
+    stream << quint8(NemoThumbnailProtocol::Completed) << id << key << ok << thumbnailPath;
+
+    NemoThumbnailProtocol::writeMessage(client->socket, payload);
+}
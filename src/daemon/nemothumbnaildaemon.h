@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef NEMOTHUMBNAILDAEMON_H
+#define NEMOTHUMBNAILDAEMON_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+
+#include "nemothumbnailprotocol_p.h"
+
+QT_BEGIN_NAMESPACE
+class QLocalServer;
+class QLocalSocket;
+QT_END_NAMESPACE
+
+class NemoThumbnailDaemon : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NemoThumbnailDaemon(QObject *parent = nullptr);
+    ~NemoThumbnailDaemon();
+
+    bool listen(const QString &socketPath);
+
+private slots:
+    void newConnection();
+    void readClient();
+    void clientDisconnected();
+    void generationFinished(const QByteArray &key, bool ok, const QString &thumbnailPath);
+
+private:
+    struct Client;
+
+    struct Waiter
+    {
+        Client *client;
+        quint32 id;
+    };
+
+    struct Job
+    {
+        QString path;
+        QByteArray key;
+        QString mimeType;
+        QVector<Waiter> waiters;
+        int size;
+        int priority;
+        bool crop;
+        bool running;
+    };
+
+    struct Client
+    {
+        QLocalSocket *socket;
+        QByteArray buffer;
+        int priority;
+    };
+
+    bool processMessage(Client *client, const QByteArray &payload);
+    void request(Client *client, quint32 id, const QString &path, const QByteArray &key, int size,
+                 bool crop, const QString &mimeType);
+    void sendCompleted(Client *client, quint32 id, const QByteArray &key, bool ok, const QString &thumbnailPath);
+    void schedule();
+
+    QLocalServer *m_server;
+    QHash<QLocalSocket *, Client *> m_clients;
+    QHash<QByteArray, Job *> m_jobs;
+    QList<Job *> m_queues[NemoThumbnailProtocol::PriorityCount];
+    QThreadPool m_pool;
+    int m_running;
+};
+
+#endif // NEMOTHUMBNAILDAEMON_H
@@ -0,0 +1,503 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemothumbnailwatcher.h"
+
+#include "nemothumbnailprotocol_p.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QSocketNotifier>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+
+const quint32 WatchMask = IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM
+        | IN_MOVED_TO | IN_ONLYDIR;
+
+// Unpaired IN_MOVED_FROM events are treated as the file moving out of the watched directories
+// once this long has passed without the matching IN_MOVED_TO.
+const int MoveTimeout = 100;
+
+QStringList normalizedDirectories(const QStringList &directories)
+{
+    QStringList normalized;
+    for (const QString &directory : directories) {
+        normalized.append(QDir::cleanPath(QFileInfo(directory).absoluteFilePath()));
+    }
+    return normalized;
+}
+
+QStringList entryNames(const QString &cachePath, const QString &sourcePath, QDir *shard, QByteArray *hash)
+{
+    *hash = NemoThumbnailProtocol::sourceHash(sourcePath);
+    shard->setPath(cachePath + QLatin1Char('/') + QLatin1String(hash->left(2)));
+
+    QStringList names;
+    const QStringList entries = shard->entryList(
+                QStringList() << QString::fromLatin1(*hash) + QLatin1String("-*"), QDir::Files);
+    for (const QString &name : entries) {
+        // Ignore entries which are still being written.
+        if (!name.contains(QLatin1String(".tmp-"))) {
+            names.append(name);
+        }
+    }
+    return names;
+}
+
+// Removes all entries of a source, or only those older than modified if it is valid.
+void removeEntries(const QString &cachePath, const QString &sourcePath,
+                   const QDateTime &modified = QDateTime())
+{
+    QDir shard;
+    QByteArray hash;
+    for (const QString &name : entryNames(cachePath, sourcePath, &shard, &hash)) {
+        if (!modified.isValid() || QFileInfo(shard, name).lastModified() < modified) {
+            shard.remove(name);
+        }
+    }
+}
+
+void moveEntries(const QString &cachePath, const QString &from, const QString &to)
+{
+    QDir shard;
+    QByteArray fromHash;
+    const QStringList names = entryNames(cachePath, from, &shard, &fromHash);
+    if (names.isEmpty()) {
+        return;
+    }
+
+    const QByteArray toHash = NemoThumbnailProtocol::sourceHash(to);
+    QDir target(cachePath + QLatin1Char('/') + QLatin1String(toHash.left(2)));
+    if (!target.exists()) {
+        target.mkpath(QStringLiteral("."));
+    }
+
+    for (const QString &name : names) {
+        // Keep the size and crop suffix of the key.
+        const QString targetName = QString::fromLatin1(toHash) + name.mid(fromHash.length());
+        if (::rename(QFile::encodeName(shard.filePath(name)).constData(),
+                     QFile::encodeName(target.filePath(targetName)).constData()) != 0) {
+            shard.remove(name);
+        }
+    }
+}
+
+}
+
+class ReconcileTask : public QRunnable
+{
+public:
+    ReconcileTask(NemoThumbnailWatcher *watcher, const QSet<QString> &previousSources,
+                  const QDateTime &since)
+        : m_watcher(watcher)
+        , m_previousSources(previousSources)
+        , m_since(since)
+    {
+    }
+
+    void run() override
+    {
+        QSet<QString> sources;
+
+        for (const QString &directory : m_watcher->m_directories) {
+            QDirIterator iterator(directory, QDir::Files, QDirIterator::Subdirectories);
+            while (iterator.hasNext()) {
+                if (m_watcher->m_aborted.load()) {
+                    return;
+                }
+
+                const QString path = iterator.next();
+                sources.insert(path);
+
+                // Only files modified since the last time sources were saved can have entries
+                // which are out of date.
+                const QDateTime modified = iterator.fileInfo().lastModified();
+                if (!m_since.isValid() || modified > m_since) {
+                    removeEntries(m_watcher->m_cachePath, path, modified);
+                }
+            }
+        }
+
+        for (const QString &path : m_previousSources) {
+            if (m_watcher->m_aborted.load()) {
+                return;
+            } else if (!sources.contains(path)) {
+                removeEntries(m_watcher->m_cachePath, path);
+            }
+        }
+
+        {
+            QMutexLocker locker(&m_watcher->m_reconcileMutex);
+            m_watcher->m_reconciledSources = sources;
+        }
+
+        QMetaObject::invokeMethod(m_watcher, "reconciled", Qt::QueuedConnection);
+    }
+
+private:
+    NemoThumbnailWatcher * const m_watcher;
+    const QSet<QString> m_previousSources;
+    const QDateTime m_since;
+};
+
+NemoThumbnailWatcher::NemoThumbnailWatcher(
+        const QString &cachePath, const QStringList &directories, QObject *parent)
+    : QObject(parent)
+    , m_cachePath(cachePath)
+    , m_directories(normalizedDirectories(directories))
+    , m_notifier(nullptr)
+    , m_fd(-1)
+    , m_reconciling(false)
+    , m_reconcileAgain(false)
+    , m_published(false)
+{
+    m_reconcilePool.setMaxThreadCount(1);
+
+    m_moveTimer.setSingleShot(true);
+    m_moveTimer.setInterval(MoveTimeout);
+    connect(&m_moveTimer, &QTimer::timeout, this, &NemoThumbnailWatcher::expireMoves);
+}
+
+NemoThumbnailWatcher::~NemoThumbnailWatcher()
+{
+    m_aborted.store(1);
+    m_reconcilePool.waitForDone();
+
+    if (m_published) {
+        QFile::remove(NemoThumbnailProtocol::watchStatePath(m_cachePath));
+        saveSources();
+    }
+
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+bool NemoThumbnailWatcher::start()
+{
+    m_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        qWarning() << "Cannot watch for changes to thumbnail sources:" << strerror(errno);
+        return false;
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &NemoThumbnailWatcher::readEvents);
+
+    for (const QString &directory : m_directories) {
+        watchTree(directory, false);
+    }
+
+    reconcile(false);
+
+    return true;
+}
+
+void NemoThumbnailWatcher::readEvents()
+{
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    for (;;) {
+        const ssize_t length = ::read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+
+        for (const char *position = buffer; position < buffer + length;) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(position);
+            position += sizeof(inotify_event) + event->len;
+
+            handleEvent(event);
+        }
+    }
+
+    if (!m_moves.isEmpty()) {
+        m_moveTimer.start();
+    }
+}
+
+void NemoThumbnailWatcher::handleEvent(const inotify_event *event)
+{
+    if (event->mask & IN_Q_OVERFLOW) {
+        qWarning() << "Thumbnail source events were lost, reconciling the cache";
+        reconcile(true);
+        return;
+    } else if (event->mask & IN_IGNORED) {
+        m_watches.remove(event->wd);
+        return;
+    }
+
+    const QString directory = m_watches.value(event->wd);
+    if (directory.isEmpty() || event->len == 0 || event->name[0] == '.') {
+        return;
+    }
+
+    const QString path = directory + QLatin1Char('/') + QFile::decodeName(event->name);
+    const bool isDirectory = event->mask & IN_ISDIR;
+
+    if (event->mask & IN_MOVED_FROM) {
+        m_moves.insert(event->cookie, { path, isDirectory });
+    } else if (event->mask & IN_MOVED_TO) {
+        // A file renamed over an existing one replaces it, as saving through a temporary file
+        // does, so the entries of the replaced file are stale whether or not the move is paired.
+        if (!isDirectory) {
+            removeEntries(m_cachePath, path);
+        }
+
+        const QHash<quint32, Move>::iterator move = m_moves.find(event->cookie);
+        if (move == m_moves.end()) {
+            if (isDirectory) {
+                watchTree(path, true);
+            } else {
+                m_sources.insert(path);
+            }
+        } else if (isDirectory) {
+            moveTree(move->path, path);
+            m_moves.erase(move);
+        } else {
+            moveEntries(m_cachePath, move->path, path);
+            m_sources.remove(move->path);
+            m_sources.insert(path);
+            m_moves.erase(move);
+        }
+    } else if (isDirectory) {
+        if (event->mask & IN_CREATE) {
+            watchTree(path, true);
+        }
+    } else if (event->mask & IN_DELETE) {
+        removeEntries(m_cachePath, path);
+        m_sources.remove(path);
+    } else if (event->mask & (IN_CLOSE_WRITE | IN_ATTRIB)) {
+        const QFileInfo info(path);
+        if (info.exists()) {
+            removeEntries(m_cachePath, path, info.lastModified());
+            m_sources.insert(path);
+        }
+    }
+}
+
+void NemoThumbnailWatcher::expireMoves()
+{
+    for (const Move &move : m_moves) {
+        if (move.directory) {
+            removeTree(move.path);
+        } else {
+            removeEntries(m_cachePath, move.path);
+            m_sources.remove(move.path);
+        }
+    }
+    m_moves.clear();
+}
+
+void NemoThumbnailWatcher::reconcile(bool full)
+{
+    if (m_reconciling) {
+        m_reconcileAgain = true;
+        return;
+    }
+    m_reconciling = true;
+
+    QSet<QString> previousSources = m_sources;
+    QDateTime since;
+
+    if (!m_published) {
+        QFile file(NemoThumbnailProtocol::watchedSourcesPath(m_cachePath));
+        if (file.open(QIODevice::ReadOnly)) {
+            since = QFileInfo(file).lastModified();
+            while (!file.atEnd()) {
+                const QByteArray line = file.readLine();
+                previousSources.insert(QFile::decodeName(line.left(line.length() - 1)));
+            }
+        }
+    }
+
+    m_reconcilePool.start(new ReconcileTask(this, previousSources, full ? QDateTime() : since));
+}
+
+void NemoThumbnailWatcher::reconciled()
+{
+    {
+        QMutexLocker locker(&m_reconcileMutex);
+        m_sources.unite(m_reconciledSources);
+        m_reconciledSources.clear();
+    }
+
+    m_reconciling = false;
+    m_published = true;
+
+    saveSources();
+    writeState();
+
+    if (m_reconcileAgain) {
+        m_reconcileAgain = false;
+        reconcile(true);
+    }
+}
+
+void NemoThumbnailWatcher::watchTree(const QString &directory, bool addSources)
+{
+    bool failed = false;
+
+    QStringList pending = { directory };
+    while (!pending.isEmpty()) {
+        const QString path = pending.takeLast();
+
+        const int watch = ::inotify_add_watch(m_fd, QFile::encodeName(path).constData(), WatchMask);
+        if (watch < 0) {
+            // Changes to files below it would go unnoticed, so entries of the watched directory
+            // it is in can no longer be trusted without comparing them against their source.
+            qWarning() << "Cannot watch" << path << "for changes:" << strerror(errno);
+            m_unwatchedDirectories.insert(rootDirectory(path));
+            failed = true;
+            continue;
+        }
+        m_watches.insert(watch, path);
+
+        const QFileInfoList entries = QDir(path).entryInfoList(
+                    QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+        for (const QFileInfo &entry : entries) {
+            if (entry.isDir()) {
+                pending.append(entry.filePath());
+            } else if (addSources) {
+                m_sources.insert(entry.filePath());
+            }
+        }
+    }
+
+    if (failed && m_published) {
+        writeState();
+    }
+}
+
+void NemoThumbnailWatcher::unwatchTree(const QString &directory)
+{
+    const QString prefix = directory + QLatin1Char('/');
+    for (QHash<int, QString>::iterator it = m_watches.begin(); it != m_watches.end();) {
+        if (*it == directory || it->startsWith(prefix)) {
+            ::inotify_rm_watch(m_fd, it.key());
+            it = m_watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void NemoThumbnailWatcher::moveTree(const QString &from, const QString &to)
+{
+    const QString prefix = from + QLatin1Char('/');
+
+    const QSet<QString> sources = m_sources;
+    for (const QString &path : sources) {
+        if (path.startsWith(prefix)) {
+            const QString target = to + path.mid(from.length());
+            moveEntries(m_cachePath, path, target);
+            m_sources.remove(path);
+            m_sources.insert(target);
+        }
+    }
+
+    // The watches move with the directories, only their paths change.
+    for (QString &path : m_watches) {
+        if (path == from || path.startsWith(prefix)) {
+            path = to + path.mid(from.length());
+        }
+    }
+}
+
+void NemoThumbnailWatcher::removeTree(const QString &directory)
+{
+    const QString prefix = directory + QLatin1Char('/');
+    for (QSet<QString>::iterator it = m_sources.begin(); it != m_sources.end();) {
+        if (it->startsWith(prefix)) {
+            removeEntries(m_cachePath, *it);
+            it = m_sources.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    unwatchTree(directory);
+}
+
+QString NemoThumbnailWatcher::rootDirectory(const QString &path) const
+{
+    for (const QString &directory : m_directories) {
+        if (path == directory || path.startsWith(directory + QLatin1Char('/'))) {
+            return directory;
+        }
+    }
+    return path;
+}
+
+void NemoThumbnailWatcher::writeState()
+{
+    QSaveFile file(NemoThumbnailProtocol::watchStatePath(m_cachePath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write" << file.fileName() << file.errorString();
+        return;
+    }
+
+    file.write(NemoThumbnailProtocol::bootId() + '\n');
+    file.write(QByteArray::number(QCoreApplication::applicationPid()) + '\n');
+    for (const QString &directory : m_directories) {
+        if (!m_unwatchedDirectories.contains(directory)) {
+            file.write(QFile::encodeName(directory) + '\n');
+        }
+    }
+    file.commit();
+}
+
+void NemoThumbnailWatcher::saveSources()
+{
+    QSaveFile file(NemoThumbnailProtocol::watchedSourcesPath(m_cachePath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write" << file.fileName() << file.errorString();
+        return;
+    }
+
+    for (const QString &path : m_sources) {
+        file.write(QFile::encodeName(path) + '\n');
+    }
+    file.commit();
+}
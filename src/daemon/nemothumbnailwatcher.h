@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef NEMOTHUMBNAILWATCHER_H
+#define NEMOTHUMBNAILWATCHER_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QSocketNotifier;
+QT_END_NAMESPACE
+
+struct inotify_event;
+
+// Keeps the cache entries of files in a set of directories in sync with their sources.
+//
+// The directories are watched with inotify.  Entries are removed when their source is deleted
+// or modified and renamed when their source is renamed.  Changes made while the watcher wasn't
+// running are found by a reconciliation pass against the list of sources known the last time
+// it ran.  Once reconciled the watched directories are published to the cache so lookups can
+// trust entries for these files without comparing them against the source.  A directory is
+// only published while all of its subdirectories are watched.
+class NemoThumbnailWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    NemoThumbnailWatcher(const QString &cachePath, const QStringList &directories,
+                         QObject *parent = nullptr);
+    ~NemoThumbnailWatcher();
+
+    bool start();
+
+private slots:
+    void readEvents();
+    void expireMoves();
+    void reconciled();
+
+private:
+    struct Move
+    {
+        QString path;
+        bool directory;
+    };
+
+    void handleEvent(const inotify_event *event);
+    void reconcile(bool full);
+    void watchTree(const QString &directory, bool addSources);
+    void unwatchTree(const QString &directory);
+    void moveTree(const QString &from, const QString &to);
+    void removeTree(const QString &directory);
+    QString rootDirectory(const QString &path) const;
+    void writeState();
+    void saveSources();
+
+    const QString m_cachePath;
+    const QStringList m_directories;
+    QHash<int, QString> m_watches;
+    QHash<quint32, Move> m_moves;
+    QSet<QString> m_sources;
+    QSet<QString> m_unwatchedDirectories;
+    QSet<QString> m_reconciledSources;
+    QMutex m_reconcileMutex;
+    QThreadPool m_reconcilePool;
+    QAtomicInt m_aborted;
+    QTimer m_moveTimer;
+    QSocketNotifier *m_notifier;
+    int m_fd;
+    bool m_reconciling;
+    bool m_reconcileAgain;
+    bool m_published;
+
+    friend class ReconcileTask;
+};
+
+#endif // NEMOTHUMBNAILWATCHER_H
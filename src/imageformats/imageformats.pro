@@ -0,0 +1,18 @@
+TARGET = nemoqoi
+
+TEMPLATE = lib
+CONFIG += qt plugin hide_symbols c++17
+QT += gui
+
+INCLUDEPATH += ../lib
+
+SOURCES += \
+    qoiplugin.cpp \
+    ../lib/nemoqoicodec.cpp
+HEADERS += \
+    ../lib/nemoqoicodec_p.h
+
+OTHER_FILES += qoi.json
+
+target.path = $$[QT_INSTALL_PLUGINS]/imageformats
+INSTALLS += target
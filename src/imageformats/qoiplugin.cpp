@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include <QImageIOHandler>
+#include <QImageIOPlugin>
+
+#include "nemoqoicodec_p.h"
+
+class NemoQoiHandler : public QImageIOHandler
+{
+public:
+    bool canRead() const override
+    {
+        if (NemoQoiCodec::canRead(device())) {
+            setFormat("qoi");
+            return true;
+        }
+        return false;
+    }
+
+    bool read(QImage *image) override
+    {
+        *image = NemoQoiCodec::read(device());
+        return !image->isNull();
+    }
+
+    bool write(const QImage &image) override
+    {
+        return NemoQoiCodec::write(device(), image);
+    }
+};
+
+class NemoQoiPlugin : public QImageIOPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "org.qt-project.Qt.QImageIOHandlerFactoryInterface" FILE "qoi.json")
+
+public:
+    Capabilities capabilities(QIODevice *device, const QByteArray &format) const override
+    {
+        if (format == "qoi") {
+            return Capabilities(CanRead | CanWrite);
+        } else if (!format.isEmpty() || !device || !device->isOpen()) {
+            return Capabilities();
+        }
+
+        Capabilities capabilities;
+        if (device->isReadable() && NemoQoiCodec::canRead(device)) {
+            capabilities |= CanRead;
+        }
+        if (device->isWritable()) {
+            capabilities |= CanWrite;
+        }
+        return capabilities;
+    }
+
+    QImageIOHandler *create(QIODevice *device, const QByteArray &format) const override
+    {
+        QImageIOHandler *handler = new NemoQoiHandler;
+        handler->setDevice(device);
+        handler->setFormat(format);
+        return handler;
+    }
+};
+
+#include "qoiplugin.moc"
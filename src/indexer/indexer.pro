@@ -0,0 +1,22 @@
+TEMPLATE = app
+TARGET = nemo-thumbnailer-indexer
+
+CONFIG += c++17
+
+INCLUDEPATH += ../lib
+LIBS += -L../lib -lnemothumbnailer-qt$${QT_MAJOR_VERSION} -lrt
+
+SOURCES += \
+    main.cpp \
+    nemothumbnailindexer.cpp
+HEADERS += \
+    nemothumbnailindexer.h
+
+target.path = /usr/bin
+
+service.files = \
+    nemo-thumbnailer-indexer.service \
+    nemo-thumbnailer-indexer.timer
+service.path = /usr/lib/systemd/user
+
+INSTALLS += target service
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include <QCoreApplication>
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "nemothumbnailindexer.h"
+
+namespace {
+
+enum {
+    IoPriorityWhoProcess = 1,
+    IoPriorityClassIdle = 3,
+    IoPriorityClassShift = 13
+};
+
+// Only use the CPU and disk when nothing else wants them.  Threads started later inherit this.
+void lowerPriority()
+{
+    ::setpriority(PRIO_PROCESS, 0, 19);
+
+    struct sched_param parameters = {};
+    ::sched_setscheduler(0, SCHED_IDLE, &parameters);
+
+    ::syscall(SYS_ioprio_set, IoPriorityWhoProcess, 0, IoPriorityClassIdle << IoPriorityClassShift);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    // Generate in this process so the work runs at its priority rather than the daemon's.
+    qputenv("NEMO_THUMBNAILER_DAEMON", "0");
+
+    QCoreApplication app(argc, argv);
+
+    lowerPriority();
+
+    NemoThumbnailIndexer indexer;
+    indexer.run();
+
+    return EXIT_SUCCESS;
+}
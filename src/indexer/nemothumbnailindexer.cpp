@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemothumbnailindexer.h"
+
+#include <nemothumbnailcache.h>
+#include "nemothumbnailprotocol_p.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QMimeDatabase>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <algorithm>
+
+namespace {
+
+// How long after the loader last marked itself busy it is considered busy.
+const qint64 BusyInterval = 5000;
+const int BusyPollInterval = 2;
+const int ConditionPollInterval = 60;
+const qint64 SaveInterval = 5000;
+
+QByteArray environment(const char *name, const QByteArray &defaultValue)
+{
+    const QByteArray value = qgetenv(name);
+    return value.isEmpty() ? defaultValue : value;
+}
+
+QByteArray readValue(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll().trimmed() : QByteArray();
+}
+
+QStringList defaultDirectories()
+{
+    return {
+        QStandardPaths::writableLocation(QStandardPaths::PicturesLocation),
+        QStandardPaths::writableLocation(QStandardPaths::MoviesLocation)
+    };
+}
+
+}
+
+NemoThumbnailIndexer::NemoThumbnailIndexer()
+    : m_statePath(NemoThumbnailProtocol::cachePath() + QLatin1String("/.indexer"))
+    , m_powerSupplyPath(QFile::decodeName(
+            environment("NEMO_THUMBNAILER_POWER_SUPPLY_PATH", "/sys/class/power_supply")))
+    , m_thermalPath(QFile::decodeName(environment("NEMO_THUMBNAILER_THERMAL_PATH", "/sys/class/thermal")))
+    , m_minimumCapacity(environment("NEMO_THUMBNAILER_INDEX_MIN_CAPACITY", "30").toInt())
+    , m_maximumTemperature(environment("NEMO_THUMBNAILER_INDEX_MAX_TEMPERATURE", "45000").toInt())
+    , m_since(0)
+    , m_started(0)
+    , m_cursorModified(0)
+    , m_busyState(nullptr)
+{
+    const QByteArray directories = qgetenv("NEMO_THUMBNAILER_INDEX_DIRS");
+    m_directories = directories.isEmpty()
+            ? defaultDirectories()
+            : QFile::decodeName(directories).split(QLatin1Char(':'), QString::SkipEmptyParts);
+
+    for (const QByteArray &size : environment("NEMO_THUMBNAILER_INDEX_SIZES", "256,512").split(',')) {
+        const int value = size.trimmed().toInt();
+        if (value > 0) {
+            m_sizes.append(QSize(value, value));
+        }
+    }
+}
+
+void NemoThumbnailIndexer::run()
+{
+    loadState();
+
+    // Without a cursor the previous pass completed, start a new one.
+    if (m_cursorPath.isEmpty()) {
+        m_started = QDateTime::currentMSecsSinceEpoch();
+        saveState(true);
+    }
+
+    NemoThumbnailCache * const cache = NemoThumbnailCache::instance();
+
+    const QVector<Source> sources = collectSources();
+    for (const Source &source : sources) {
+        if (completed(source)) {
+            continue;
+        }
+
+        waitUntilIdle();
+
+        for (const QSize &size : m_sizes) {
+            cache->requestThumbnail(source.path, size, true, true, source.mimeType);
+        }
+
+        m_cursorModified = source.modified;
+        m_cursorPath = source.path;
+        saveState(false);
+    }
+
+    m_since = m_started;
+    m_cursorModified = 0;
+    m_cursorPath.clear();
+    saveState(true);
+}
+
+QVector<NemoThumbnailIndexer::Source> NemoThumbnailIndexer::collectSources() const
+{
+    const QMimeDatabase mimeDatabase;
+
+    QVector<Source> sources;
+    for (const QString &directory : m_directories) {
+        QDirIterator iterator(directory, QDir::Files, QDirIterator::Subdirectories);
+        while (iterator.hasNext()) {
+            const QString path = iterator.next();
+            const qint64 modified = iterator.fileInfo().lastModified().toMSecsSinceEpoch();
+            if (modified <= m_since) {
+                continue;
+            }
+
+            const QString mimeType = mimeDatabase.mimeTypeForFile(path, QMimeDatabase::MatchExtension).name();
+            if (mimeType.startsWith(QLatin1String("image/")) || mimeType.startsWith(QLatin1String("video/"))) {
+                sources.append({ path, mimeType, modified });
+            }
+        }
+    }
+
+    // Newest first, the path keeps the order stable so progress can be resumed.
+    std::sort(sources.begin(), sources.end(), [](const Source &left, const Source &right) {
+        return left.modified != right.modified
+                ? left.modified > right.modified
+                : left.path < right.path;
+    });
+
+    return sources;
+}
+
+bool NemoThumbnailIndexer::completed(const Source &source) const
+{
+    // Files modified after the pass started sort before the cursor but haven't been visited.
+    if (m_cursorPath.isEmpty() || source.modified > m_started) {
+        return false;
+    }
+    return source.modified != m_cursorModified
+            ? source.modified > m_cursorModified
+            : source.path <= m_cursorPath;
+}
+
+void NemoThumbnailIndexer::waitUntilIdle() const
+{
+    for (;;) {
+        if (interactiveBusy()) {
+            QThread::sleep(BusyPollInterval);
+        } else if (!powerAvailable() || !temperatureAcceptable()) {
+            QThread::sleep(ConditionPollInterval);
+        } else {
+            return;
+        }
+    }
+}
+
+bool NemoThumbnailIndexer::interactiveBusy() const
+{
+    // The loader may not have run yet.
+    if (!m_busyState) {
+        m_busyState = NemoThumbnailProtocol::mapBusyState(false);
+    }
+    return m_busyState
+            && NemoThumbnailProtocol::monotonicTime() - m_busyState->load(std::memory_order_relaxed) < BusyInterval;
+}
+
+bool NemoThumbnailIndexer::powerAvailable() const
+{
+    int capacity = -1;
+
+    const QDir supplies(m_powerSupplyPath);
+    for (const QString &name : supplies.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        const QString supply = supplies.filePath(name) + QLatin1Char('/');
+        if (readValue(supply + QLatin1String("type")) == "Battery") {
+            bool ok = false;
+            const int value = readValue(supply + QLatin1String("capacity")).toInt(&ok);
+            if (ok) {
+                capacity = std::max(capacity, value);
+            }
+        } else if (readValue(supply + QLatin1String("online")) == "1") {
+            return true;
+        }
+    }
+
+    // Devices without a battery are always powered.
+    return capacity < 0 || capacity >= m_minimumCapacity;
+}
+
+bool NemoThumbnailIndexer::temperatureAcceptable() const
+{
+    const QDir thermal(m_thermalPath);
+    const QStringList zones = thermal.entryList(
+                QStringList() << QStringLiteral("thermal_zone*"), QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &zone : zones) {
+        bool ok = false;
+        const int temperature = readValue(thermal.filePath(zone) + QLatin1String("/temp")).toInt(&ok);
+        if (ok && temperature > m_maximumTemperature) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NemoThumbnailIndexer::loadState()
+{
+    const QSettings state(m_statePath, QSettings::IniFormat);
+
+    m_since = state.value(QStringLiteral("since"), 0).toLongLong();
+    m_started = state.value(QStringLiteral("started"), 0).toLongLong();
+    m_cursorModified = state.value(QStringLiteral("cursorModified"), 0).toLongLong();
+    m_cursorPath = state.value(QStringLiteral("cursorPath")).toString();
+}
+
+void NemoThumbnailIndexer::saveState(bool force)
+{
+    if (!force && m_saveTimer.isValid() && !m_saveTimer.hasExpired(SaveInterval)) {
+        return;
+    }
+    m_saveTimer.start();
+
+    QSettings state(m_statePath, QSettings::IniFormat);
+    state.setValue(QStringLiteral("since"), m_since);
+    state.setValue(QStringLiteral("started"), m_started);
+    state.setValue(QStringLiteral("cursorModified"), m_cursorModified);
+    state.setValue(QStringLiteral("cursorPath"), m_cursorPath);
+    state.sync();
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef NEMOTHUMBNAILINDEXER_H
+#define NEMOTHUMBNAILINDEXER_H
+
+#include <QElapsedTimer>
+#include <QSize>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+
+// Generates thumbnails for the files in a set of directories ahead of them being viewed.
+//
+// Files are visited newest first and thumbnails generated for each of the configured sizes.
+// Progress is saved so an interrupted pass resumes where it stopped, and a later pass only
+// visits files modified since the previous pass started.  Generation pauses while the
+// interactive loader is busy, the battery is low or the device is hot.
+class NemoThumbnailIndexer
+{
+public:
+    NemoThumbnailIndexer();
+
+    void run();
+
+private:
+    struct Source
+    {
+        QString path;
+        QString mimeType;
+        qint64 modified;
+    };
+
+    QVector<Source> collectSources() const;
+    bool completed(const Source &source) const;
+    void waitUntilIdle() const;
+    bool interactiveBusy() const;
+    bool powerAvailable() const;
+    bool temperatureAcceptable() const;
+    void loadState();
+    void saveState(bool force);
+
+    QStringList m_directories;
+    QVector<QSize> m_sizes;
+    QString m_statePath;
+    QString m_powerSupplyPath;
+    QString m_thermalPath;
+    int m_minimumCapacity;
+    int m_maximumTemperature;
+    qint64 m_since;
+    qint64 m_started;
+    qint64 m_cursorModified;
+    QString m_cursorPath;
+    QElapsedTimer m_saveTimer;
+    mutable std::atomic<qint64> *m_busyState;
+};
+
+#endif // NEMOTHUMBNAILINDEXER_H
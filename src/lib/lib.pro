@@ -1,10 +1,16 @@
 TEMPLATE = lib
 TARGET = nemothumbnailer-qt$${QT_MAJOR_VERSION}
 
-CONFIG += qt hide_symbols create_pc create_prl c++17 link_pkgconfig
+# The layout of the exported classes changed with configurable sizes and placeholders, bump the
+# major version with any further incompatible change.
+VERSION = 2.0.0
+
+CONFIG += qt hide_symbols create_pc create_prl c++17 link_pkgconfig simd
 
 QT += \
-    gui-private
+    core-private \
+    gui-private \
+    network
 
 packagesExist(mlite$${QT_MAJOR_VERSION}) {
     message("Building with mlite$${QT_MAJOR_VERSION} support")
@@ -14,16 +20,60 @@ packagesExist(mlite$${QT_MAJOR_VERSION}) {
     warning("mlite$${QT_MAJOR_VERSION} not available;")
 }
 
+# The decoder uses the extended color spaces and partial decoding of libjpeg-turbo 1.5 or
+# later, which is also the first version to install libturbojpeg.pc.
+packagesExist(libjpeg libturbojpeg) {
+    message("Building with libjpeg-turbo support")
+    PKGCONFIG += libjpeg
+    DEFINES += HAS_LIBJPEG
+    SOURCES += nemojpegdecoder.cpp
+    HEADERS += nemojpegdecoder_p.h
+} else {
+    warning("libjpeg-turbo not available; JPEG thumbnails will be decoded with QImageReader")
+}
+
+packagesExist(liburing) {
+    message("Building with io_uring support")
+    PKGCONFIG += liburing
+    DEFINES += HAS_LIBURING
+} else {
+    warning("liburing not available; cache lookups will be batched over a thread pool")
+}
+
 DEFINES += BUILD_NEMO_QML_PLUGIN_THUMBNAILER_LIB
 
 
 SOURCES += \
+    nemobatchstat.cpp \
+    nemoimagealpha.cpp \
     nemoimagemetadata.cpp \
-    nemothumbnailcache.cpp
+    nemoimagescaler.cpp \
+    nemoqoicodec.cpp \
+    nemosourcefile.cpp \
+    nemothumbnailcache.cpp \
+    nemothumbnaildaemonclient.cpp \
+    nemothumbnailgenerators.cpp \
+    nemothumbnailtrace.cpp \
+    nemothumbnailwriter.cpp
 HEADERS += \
+    nemobatchstat_p.h \
+    nemoimagealpha_p.h \
     nemoimagemetadata.h \
+    nemoimagescaler_p.h \
+    nemoqoicodec_p.h \
+    nemosourcefile_p.h \
     nemothumbnailcache.h \
-    nemothumbnailexports.h
+    nemothumbnaildaemonclient_p.h \
+    nemothumbnailexports.h \
+    nemothumbnailgenerator.h \
+    nemothumbnailgenerators_p.h \
+    nemothumbnailprotocol_p.h \
+    nemothumbnailtrace_p.h \
+    nemothumbnailwriter_p.h
+
+SSE2_SOURCES += nemoimagealpha_sse2.cpp nemoimagescaler_sse2.cpp
+AVX2_SOURCES += nemoimagealpha_avx2.cpp nemoimagescaler_avx2.cpp
+NEON_SOURCES += nemoimagealpha_neon.cpp nemoimagescaler_neon.cpp
 
 PLUGIN_IMPORT_PATH = $$[QT_INSTALL_QML]/Nemo/Thumbnailer
 DEFINES += NEMO_THUMBNAILER_DIR=\\\"$$PLUGIN_IMPORT_PATH/thumbnailers\\\"
@@ -33,7 +83,8 @@ headers.path = /usr/include/nemothumbnailer-qt$${QT_MAJOR_VERSION}
 headers.files =\
     nemothumbnailcache.h \
     nemoimagemetadata.h \
-    nemothumbnailexports.h
+    nemothumbnailexports.h \
+    nemothumbnailgenerator.h
 
 QMAKE_PKGCONFIG_NAME = lib$$TARGET
 QMAKE_PKGCONFIG_DESCRIPTION = Library for generating and accessing thumbnail images
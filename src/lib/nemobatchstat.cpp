@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include "nemobatchstat_p.h"
+
+#include <QAtomicInt>
+#include <QLoggingCategory>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef HAS_LIBURING
+#include <liburing.h>
+#endif
+
+Q_DECLARE_LOGGING_CATEGORY(thumbnailer)
+
+namespace {
+
+// Batches this small aren't worth waking other threads for.
+const int MinimumParallelCount = 4;
+const int StatThreadCount = 8;
+
+void statFile(const QByteArray &path, NemoBatchStat::Result *result)
+{
+    struct stat status;
+    if (::stat(path.constData(), &status) == 0) {
+        result->exists = true;
+        result->modified = qint64(status.st_mtim.tv_sec) * 1000 + status.st_mtim.tv_nsec / 1000000;
+    }
+}
+
+class StatTask : public QRunnable
+{
+public:
+    StatTask(const QVector<QByteArray> &paths, QVector<NemoBatchStat::Result> *results,
+             int begin, int end, QSemaphore *finished)
+        : m_paths(paths)
+        , m_results(results)
+        , m_begin(begin)
+        , m_end(end)
+        , m_finished(finished)
+    {
+    }
+
+    void run() override
+    {
+        for (int i = m_begin; i < m_end; ++i) {
+            statFile(m_paths.at(i), &(*m_results)[i]);
+        }
+        m_finished->release();
+    }
+
+private:
+    const QVector<QByteArray> &m_paths;
+    QVector<NemoBatchStat::Result> *m_results;
+    const int m_begin;
+    const int m_end;
+    QSemaphore * const m_finished;
+};
+
+class StatThreadPool : public QThreadPool
+{
+public:
+    StatThreadPool()
+    {
+        setMaxThreadCount(StatThreadCount);
+    }
+};
+
+Q_GLOBAL_STATIC(StatThreadPool, statThreadPool)
+
+void statInParallel(const QVector<QByteArray> &paths, QVector<NemoBatchStat::Result> *results)
+{
+    if (paths.count() < MinimumParallelCount) {
+        for (int i = 0; i < paths.count(); ++i) {
+            statFile(paths.at(i), &(*results)[i]);
+        }
+        return;
+    }
+
+    const int taskCount = qMin(paths.count(), StatThreadCount);
+    QSemaphore finished;
+    for (int task = 0; task < taskCount; ++task) {
+        StatTask *statTask = new StatTask(
+                    paths, results,
+                    paths.count() * task / taskCount,
+                    paths.count() * (task + 1) / taskCount,
+                    &finished);
+        statTask->setAutoDelete(true);
+        statThreadPool->start(statTask);
+    }
+    finished.acquire(taskCount);
+}
+
+#ifdef HAS_LIBURING
+
+const unsigned RingEntries = 64;
+
+// Cleared if the kernel doesn't support io_uring or the statx operation, or it's forbidden
+// by a seccomp filter.
+QAtomicInt ringAvailable(1);
+
+// A ring for each thread, so probes from several loaders don't contend for one.
+//
+// The operations point into the ring's own copy of the paths and its status buffers rather than
+// the caller's, and every operation submitted is waited for before stat() returns, so the kernel
+// never writes to memory which has been released.
+class Ring
+{
+public:
+    Ring()
+    {
+        m_valid = ::io_uring_queue_init(RingEntries, &m_ring, 0) == 0;
+        if (!m_valid) {
+            qCDebug(thumbnailer) << "io_uring unavailable, probing the cache from a thread pool";
+            ringAvailable.store(0);
+        }
+    }
+
+    ~Ring()
+    {
+        if (m_valid) {
+            reap(0, nullptr, nullptr);
+            ::io_uring_queue_exit(&m_ring);
+        }
+    }
+
+    bool stat(const QVector<QByteArray> &paths, QVector<NemoBatchStat::Result> *results)
+    {
+        if (!m_valid || m_inFlight > 0 || !ringAvailable.load()) {
+            return false;
+        }
+
+        m_paths = paths;
+
+        bool ok = true;
+        bool supported = true;
+        for (int begin = 0; ok && begin < m_paths.count(); begin += RingEntries) {
+            const int end = qMin<int>(begin + RingEntries, m_paths.count());
+
+            for (int i = begin; i < end; ++i) {
+                io_uring_sqe *entry = ::io_uring_get_sqe(&m_ring);
+                if (!entry) {
+                    ok = false;
+                    break;
+                }
+                ::io_uring_prep_statx(entry, AT_FDCWD, m_paths.at(i).constData(), 0, STATX_MTIME,
+                                      &m_statuses[i - begin]);
+                ::io_uring_sqe_set_data(entry, reinterpret_cast<void *>(quintptr(i)));
+            }
+
+            // Whatever was prepared is submitted and waited for, even if preparing failed.
+            ok = submit() && ok;
+            ok = reap(begin, results, &supported) && ok;
+        }
+
+        if (!ok) {
+            return fail();
+        } else if (!supported) {
+            qCDebug(thumbnailer) << "io_uring statx unsupported, probing the cache from a thread pool";
+            return fail();
+        }
+
+        m_paths.clear();
+        return true;
+    }
+
+private:
+    // Submits all prepared operations.  If submitting fails the remaining operations are left
+    // in the submission queue, which is never entered again.
+    bool submit()
+    {
+        while (::io_uring_sq_ready(&m_ring) > 0) {
+            const int submitted = ::io_uring_submit(&m_ring);
+            if (submitted == -EINTR || submitted == -EAGAIN) {
+                continue;
+            } else if (submitted < 0) {
+                return false;
+            }
+            m_inFlight += submitted;
+        }
+        return true;
+    }
+
+    // Waits for every operation in flight, storing the results of the batch starting at begin
+    // if results is given.
+    bool reap(int begin, QVector<NemoBatchStat::Result> *results, bool *supported)
+    {
+        while (m_inFlight > 0) {
+            io_uring_cqe *completion = nullptr;
+            const int error = ::io_uring_wait_cqe(&m_ring, &completion);
+            if (error == -EINTR) {
+                // Interrupted by a signal, the operations are still in flight.
+                continue;
+            } else if (error != 0) {
+                // The buffers stay referenced by the ring so the operations can't write to
+                // released memory.
+                return false;
+            }
+            --m_inFlight;
+
+            const int i = int(quintptr(::io_uring_cqe_get_data(completion)));
+            const int res = completion->res;
+            ::io_uring_cqe_seen(&m_ring, completion);
+
+            if (!results) {
+                continue;
+            } else if (res == 0) {
+                const struct statx &status = m_statuses[i - begin];
+                NemoBatchStat::Result &result = (*results)[i];
+                result.exists = true;
+                result.modified = qint64(status.stx_mtime.tv_sec) * 1000 + status.stx_mtime.tv_nsec / 1000000;
+            } else if (res == -EINVAL || res == -EOPNOTSUPP) {
+                // Kernels before 5.6 don't know the statx operation.
+                *supported = false;
+            }
+        }
+        return true;
+    }
+
+    // Don't use io_uring again, the thread pool is used instead.
+    bool fail()
+    {
+        ringAvailable.store(0);
+        return false;
+    }
+
+    io_uring m_ring;
+    QVector<QByteArray> m_paths;
+    struct statx m_statuses[RingEntries];
+    int m_inFlight = 0;
+    bool m_valid = false;
+};
+
+#endif
+
+}
+
+QVector<NemoBatchStat::Result> NemoBatchStat::stat(const QVector<QByteArray> &paths)
+{
+    QVector<Result> results(paths.count());
+
+#ifdef HAS_LIBURING
+    if (paths.count() > 1 && ringAvailable.load()) {
+        static thread_local Ring ring;
+        if (ring.stat(paths, &results)) {
+            return results;
+        }
+        results = QVector<Result>(paths.count());
+    }
+#endif
+
+    statInParallel(paths, &results);
+    return results;
+}
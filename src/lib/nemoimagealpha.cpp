@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include "nemoimagealpha_p.h"
+
+#include <QIODevice>
+#include <QtEndian>
+
+#include <QtGui/private/qimage_p.h>
+
+#include <cstring>
+
+namespace {
+
+const char PngSignature[] = "\x89PNG\r\n\x1a\n";
+const int PngSignatureLength = 8;
+const int PngChunkHeaderLength = 8;
+const int PngChunkCrcLength = 4;
+// Chunks preceding the image data are small, don't look further than this for a tRNS chunk.
+const int PngHeaderSearchLength = 64 * 1024;
+
+enum {
+    PngColorGrayscale = 0,
+    PngColorTruecolor = 2,
+    PngColorIndexed = 3
+};
+
+bool pngIsOpaque(QIODevice *device)
+{
+    const QByteArray header = device->peek(PngHeaderSearchLength);
+    const uchar * const data = reinterpret_cast<const uchar *>(header.constData());
+
+    // The IHDR chunk is always first, its color type says whether pixels have alpha.
+    const int colorTypeOffset = PngSignatureLength + PngChunkHeaderLength + 9;
+    if (header.size() <= colorTypeOffset
+            || std::memcmp(data, PngSignature, PngSignatureLength) != 0
+            || std::memcmp(data + PngSignatureLength + 4, "IHDR", 4) != 0) {
+        return false;
+    }
+
+    const int colorType = data[colorTypeOffset];
+    if (colorType != PngColorGrayscale && colorType != PngColorTruecolor && colorType != PngColorIndexed) {
+        return false;
+    }
+
+    // Other color types may still have a transparent color or palette entries in a tRNS chunk,
+    // which must come before the image data.
+    int offset = PngSignatureLength;
+    while (offset + PngChunkHeaderLength <= header.size()) {
+        const quint32 length = qFromBigEndian<quint32>(data + offset);
+        const uchar * const type = data + offset + 4;
+        if (std::memcmp(type, "tRNS", 4) == 0) {
+            return false;
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            return true;
+        }
+        offset += PngChunkHeaderLength + PngChunkCrcLength + qMin<quint32>(length, PngHeaderSearchLength);
+    }
+
+    return false;
+}
+
+NemoImageAlpha::OpaqueFunction selectIsOpaque()
+{
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+    if (qCpuHasFeature(AVX2)) {
+        return NemoImageAlpha::isOpaque_avx2;
+    }
+#endif
+#if defined(QT_COMPILER_SUPPORTS_SSE2)
+    if (qCpuHasFeature(SSE2)) {
+        return NemoImageAlpha::isOpaque_sse2;
+    }
+#endif
+#if defined(QT_COMPILER_SUPPORTS_NEON)
+    if (qCpuHasFeature(NEON)) {
+        return NemoImageAlpha::isOpaque_neon;
+    }
+#endif
+    return NemoImageAlpha::isOpaque;
+}
+
+}
+
+bool NemoImageAlpha::sourceIsOpaque(QIODevice *device, const QByteArray &format)
+{
+    if (format == "jpeg" || format == "jpg") {
+        return true;
+    } else if (format == "png" && device) {
+        return pngIsOpaque(device);
+    } else {
+        return false;
+    }
+}
+
+bool NemoImageAlpha::isOpaque(const uchar *pixels, int count)
+{
+    for (const uchar * const end = pixels + count * 4; pixels != end; pixels += 4) {
+        if (pixels[3] != 0xff) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NemoImageAlpha::hasAlphaPixels(const QImage &image)
+{
+    if (!image.hasAlphaChannel()) {
+        return false;
+    }
+
+    switch (image.format()) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+#endif
+    case QImage::Format_RGBA8888:
+    case QImage::Format_RGBA8888_Premultiplied: {
+        static const OpaqueFunction opaque = selectIsOpaque();
+        for (int y = 0; y < image.height(); ++y) {
+            if (!opaque(image.constScanLine(y), image.width())) {
+                return true;
+            }
+        }
+        return false;
+    }
+    default:
+        return !image.data_ptr() || image.data_ptr()->checkForAlphaPixels();
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include "nemoimagealpha_p.h"
+
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+
+#include <immintrin.h>
+
+bool NemoImageAlpha::isOpaque_avx2(const uchar *pixels, int count)
+{
+    // Setting every byte but alpha leaves all ones only if alpha is opaque.
+    const __m256i colorMask = _mm256_set1_epi32(0x00ffffff);
+    const __m256i ones = _mm256_set1_epi32(-1);
+
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i *row = reinterpret_cast<const __m256i *>(pixels + i * 4);
+        const __m256i combined = _mm256_and_si256(
+                    _mm256_and_si256(_mm256_loadu_si256(row), _mm256_loadu_si256(row + 1)),
+                    _mm256_and_si256(_mm256_loadu_si256(row + 2), _mm256_loadu_si256(row + 3)));
+        if (!_mm256_testc_si256(_mm256_or_si256(combined, colorMask), ones)) {
+            return false;
+        }
+    }
+
+    return isOpaque_sse2(pixels + i * 4, count - i);
+}
+
+#endif
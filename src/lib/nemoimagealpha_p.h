@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#ifndef NEMOIMAGEALPHA_P_H
+#define NEMOIMAGEALPHA_P_H
+
+#include <QImage>
+
+#include <QtCore/private/qsimd_p.h>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+// Decides whether an image with an alpha channel actually has any translucent pixels.
+//
+// Where possible this is decided from the header of the source so the decoded pixels don't
+// need to be examined.  Cache entries record the result in their format, JPEG and three channel
+// QOI entries are opaque, so loading an entry never needs to check.
+
+namespace NemoImageAlpha {
+
+// True if the header of an encoded image on device declares it can't have translucent pixels.
+// JPEG never has alpha and PNG only has it if the color type includes alpha or there is a tRNS
+// chunk.  The device position is left unchanged.
+bool sourceIsOpaque(QIODevice *device, const QByteArray &format);
+
+// True if any pixel of image is translucent.  Stops at the first translucent pixel.
+bool hasAlphaPixels(const QImage &image);
+
+// Checks count pixels with alpha in the fourth byte of each, exposed for the SIMD
+// implementations.
+typedef bool (*OpaqueFunction)(const uchar *pixels, int count);
+
+bool isOpaque(const uchar *pixels, int count);
+#if defined(QT_COMPILER_SUPPORTS_SSE2)
+bool isOpaque_sse2(const uchar *pixels, int count);
+#endif
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+bool isOpaque_avx2(const uchar *pixels, int count);
+#endif
+#if defined(QT_COMPILER_SUPPORTS_NEON)
+bool isOpaque_neon(const uchar *pixels, int count);
+#endif
+
+}
+
+#endif // NEMOIMAGEALPHA_P_H
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include "nemoimagealpha_p.h"
+
+#if defined(QT_COMPILER_SUPPORTS_SSE2)
+
+#include <emmintrin.h>
+
+bool NemoImageAlpha::isOpaque_sse2(const uchar *pixels, int count)
+{
+    // Setting every byte but alpha leaves all ones only if alpha is opaque.
+    const __m128i colorMask = _mm_set1_epi32(0x00ffffff);
+    const __m128i ones = _mm_set1_epi32(-1);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i *row = reinterpret_cast<const __m128i *>(pixels + i * 4);
+        const __m128i combined = _mm_and_si128(
+                    _mm_and_si128(_mm_loadu_si128(row), _mm_loadu_si128(row + 1)),
+                    _mm_and_si128(_mm_loadu_si128(row + 2), _mm_loadu_si128(row + 3)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(combined, colorMask), ones)) != 0xffff) {
+            return false;
+        }
+    }
+
+    return isOpaque(pixels + i * 4, count - i);
+}
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemoimagescaler_p.h"
+
+#include <QVarLengthArray>
+#include <QVector>
+
+#include <cstring>
+
+namespace {
+
+// Weights are fixed point fractions of one destination pixel.
+const int WeightBits = 14;
+const quint32 WeightOne = 1 << WeightBits;
+
+// Accumulated rows are reduced to 16 bits before the horizontal pass so the horizontal sums of
+// (pixel << 8) * weight stay within 32 bits.
+const int AccumulatorShift = WeightBits - 8;
+const int ResultShift = 8 + WeightBits;
+
+struct Span
+{
+    int first;
+    int count;
+    int weightOffset;
+};
+
+// Computes the source pixels covering each destination pixel along one axis and their
+// weights.  The weights for each destination pixel always sum to exactly WeightOne.
+void computeSpans(int sourceLength, int destinationLength, QVector<Span> *spans, QVector<quint16> *weights)
+{
+    spans->resize(destinationLength);
+    weights->clear();
+    weights->reserve(destinationLength * ((sourceLength + destinationLength - 1) / destinationLength + 1));
+
+    for (int d = 0; d < destinationLength; ++d) {
+        // Positions are measured in units of 1 / destinationLength source pixels.
+        const qint64 start = qint64(d) * sourceLength;
+        const qint64 end = start + sourceLength;
+
+        Span &span = (*spans)[d];
+        span.first = int(start / destinationLength);
+        span.count = 0;
+        span.weightOffset = weights->count();
+
+        qint64 covered = 0;
+        quint32 previousWeight = 0;
+        for (int s = span.first; qint64(s) * destinationLength < end; ++s) {
+            const qint64 pixelStart = qMax<qint64>(start, qint64(s) * destinationLength);
+            const qint64 pixelEnd = qMin<qint64>(end, qint64(s + 1) * destinationLength);
+
+            covered += pixelEnd - pixelStart;
+
+            const quint32 cumulativeWeight = quint32((covered * WeightOne + sourceLength / 2) / sourceLength);
+            weights->append(quint16(cumulativeWeight - previousWeight));
+            previousWeight = cumulativeWeight;
+            ++span.count;
+        }
+    }
+}
+
+NemoImageScaler::AccumulateFunction selectAccumulate()
+{
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+    if (qCpuHasFeature(AVX2)) {
+        return NemoImageScaler::accumulateRow_avx2;
+    }
+#endif
+#if defined(QT_COMPILER_SUPPORTS_SSE2)
+    if (qCpuHasFeature(SSE2)) {
+        return NemoImageScaler::accumulateRow_sse2;
+    }
+#endif
+#if defined(QT_COMPILER_SUPPORTS_NEON)
+    if (qCpuHasFeature(NEON)) {
+        return NemoImageScaler::accumulateRow_neon;
+    }
+#endif
+    return NemoImageScaler::accumulateRow;
+}
+
+}
+
+bool NemoImageScaler::supportsFormat(QImage::Format format)
+{
+    switch (format) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+        return true;
+    default:
+        return false;
+    }
+}
+
+QImage NemoImageScaler::scaled(const QImage &image, const QSize &size)
+{
+    if (image.isNull() || size.isEmpty()) {
+        return QImage();
+    } else if (image.size() == size) {
+        return image;
+    } else if (size.width() > image.width() || size.height() > image.height()) {
+        return image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    const QImage source = supportsFormat(image.format())
+            ? image
+            : image.convertToFormat(image.hasAlphaChannel()
+                    ? QImage::Format_ARGB32_Premultiplied
+                    : QImage::Format_RGB32);
+
+    QImage result(size, source.format());
+    if (result.isNull()) {
+        return QImage();
+    }
+
+    static const AccumulateFunction accumulate = selectAccumulate();
+
+    scale(source.constBits(), source.width(), source.height(), source.bytesPerLine(),
+          result.bits(), result.width(), result.height(), result.bytesPerLine(),
+          accumulate);
+
+    return result;
+}
+
+QImage NemoImageScaler::scaleImage(const QImage &image, const QSize &requestedSize, bool crop,
+                                   Qt::TransformationMode mode)
+{
+    const QSize scaledSize = image.size().scaled(
+                requestedSize, crop ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio);
+
+    QImage scaledImage;
+    if (image.size() == requestedSize || image.isNull()) {
+        scaledImage = image;
+    } else if (mode == Qt::FastTransformation
+               && scaledSize.width() <= image.width()
+               && scaledSize.height() <= image.height()) {
+        // Area averaging is barely more expensive than nearest neighbour when downscaling
+        // but doesn't alias.
+        scaledImage = scaled(image, scaledSize);
+    } else {
+        scaledImage = image.scaled(scaledSize, Qt::IgnoreAspectRatio, mode);
+    }
+
+    if (crop && scaledImage.size() != requestedSize) {
+        QRect cropRect(0, 0, requestedSize.width(), requestedSize.height());
+        cropRect.moveCenter(QPoint(scaledImage.width() / 2, scaledImage.height() / 2));
+
+        return scaledImage.copy(cropRect);
+    } else {
+        return scaledImage;
+    }
+}
+
+void NemoImageScaler::accumulateRow(quint32 *accumulator, const uchar *row, int count, quint16 weight)
+{
+    for (int i = 0; i < count; ++i) {
+        accumulator[i] += quint32(row[i]) * weight;
+    }
+}
+
+void NemoImageScaler::scale(
+        const uchar *source, int sourceWidth, int sourceHeight, int sourceStride,
+        uchar *destination, int destinationWidth, int destinationHeight, int destinationStride,
+        AccumulateFunction accumulate)
+{
+    QVector<Span> rows;
+    QVector<quint16> rowWeights;
+    computeSpans(sourceHeight, destinationHeight, &rows, &rowWeights);
+
+    QVector<Span> columns;
+    QVector<quint16> columnWeights;
+    computeSpans(sourceWidth, destinationWidth, &columns, &columnWeights);
+
+    const int rowBytes = sourceWidth * 4;
+    QVarLengthArray<quint32, 4096> accumulator(rowBytes);
+
+    for (int y = 0; y < destinationHeight; ++y) {
+        // Vertical pass, this touches every source pixel and is where the SIMD kernels matter.
+        std::memset(accumulator.data(), 0, rowBytes * sizeof(quint32));
+
+        const Span &row = rows.at(y);
+        for (int i = 0; i < row.count; ++i) {
+            const quint16 weight = rowWeights.at(row.weightOffset + i);
+            if (weight) {
+                accumulate(accumulator.data(), source + qptrdiff(row.first + i) * sourceStride, rowBytes, weight);
+            }
+        }
+
+        for (int i = 0; i < rowBytes; ++i) {
+            accumulator[i] = (accumulator[i] + (1 << (AccumulatorShift - 1))) >> AccumulatorShift;
+        }
+
+        // Horizontal pass over the single accumulated row.
+        uchar *out = destination + qptrdiff(y) * destinationStride;
+        for (int x = 0; x < destinationWidth; ++x) {
+            const Span &column = columns.at(x);
+            const quint32 *in = accumulator.constData() + column.first * 4;
+            const quint16 *weights = columnWeights.constData() + column.weightOffset;
+
+            quint32 sum[4] = { 0, 0, 0, 0 };
+            for (int i = 0; i < column.count; ++i, in += 4) {
+                const quint32 weight = weights[i];
+                sum[0] += in[0] * weight;
+                sum[1] += in[1] * weight;
+                sum[2] += in[2] * weight;
+                sum[3] += in[3] * weight;
+            }
+
+            for (int c = 0; c < 4; ++c) {
+                *out++ = uchar((sum[c] + (1u << (ResultShift - 1))) >> ResultShift);
+            }
+        }
+    }
+}
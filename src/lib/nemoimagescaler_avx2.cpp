@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemoimagescaler_p.h"
+
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+
+#include <immintrin.h>
+
+void NemoImageScaler::accumulateRow_avx2(quint32 *accumulator, const uchar *row, int count, quint16 weight)
+{
+    const __m256i weights = _mm256_set1_epi32(weight);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        const __m256i low = _mm256_cvtepu8_epi32(pixels);
+        const __m256i high = _mm256_cvtepu8_epi32(_mm_unpackhi_epi64(pixels, pixels));
+
+        __m256i *sums = reinterpret_cast<__m256i *>(accumulator + i);
+        _mm256_storeu_si256(sums, _mm256_add_epi32(
+                _mm256_loadu_si256(sums), _mm256_mullo_epi32(low, weights)));
+        _mm256_storeu_si256(sums + 1, _mm256_add_epi32(
+                _mm256_loadu_si256(sums + 1), _mm256_mullo_epi32(high, weights)));
+    }
+
+    accumulateRow(accumulator + i, row + i, count - i, weight);
+}
+
+#endif
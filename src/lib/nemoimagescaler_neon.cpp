@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemoimagescaler_p.h"
+
+#if defined(QT_COMPILER_SUPPORTS_NEON)
+
+#include <arm_neon.h>
+
+void NemoImageScaler::accumulateRow_neon(quint32 *accumulator, const uchar *row, int count, quint16 weight)
+{
+    const uint16x4_t weights = vdup_n_u16(weight);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t pixels = vld1q_u8(row + i);
+        const uint16x8_t low = vmovl_u8(vget_low_u8(pixels));
+        const uint16x8_t high = vmovl_u8(vget_high_u8(pixels));
+
+        quint32 *sums = accumulator + i;
+        vst1q_u32(sums, vmlal_u16(vld1q_u32(sums), vget_low_u16(low), weights));
+        vst1q_u32(sums + 4, vmlal_u16(vld1q_u32(sums + 4), vget_high_u16(low), weights));
+        vst1q_u32(sums + 8, vmlal_u16(vld1q_u32(sums + 8), vget_low_u16(high), weights));
+        vst1q_u32(sums + 12, vmlal_u16(vld1q_u32(sums + 12), vget_high_u16(high), weights));
+    }
+
+    accumulateRow(accumulator + i, row + i, count - i, weight);
+}
+
+#endif
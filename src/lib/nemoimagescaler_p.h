@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef NEMOIMAGESCALER_P_H
+#define NEMOIMAGESCALER_P_H
+
+#include <QImage>
+
+#include <QtCore/private/qsimd_p.h>
+
+// Area averaging downscaler for the 32 bit formats thumbnails are stored and uploaded in.
+//
+// Every destination pixel is the coverage weighted average of the source pixels underneath it,
+// which doesn't alias like nearest neighbour sampling and is much cheaper than
+// Qt::SmoothTransformation.  Channels are averaged independently, so the byte order of the
+// format doesn't matter as long as alpha is premultiplied.
+
+namespace NemoImageScaler {
+
+bool supportsFormat(QImage::Format format);
+
+// Scales image to exactly size, ignoring the aspect ratio.  Upscaling in either dimension falls
+// back to Qt::SmoothTransformation.
+QImage scaled(const QImage &image, const QSize &size);
+
+// Scales image to fill (crop) or fit within requestedSize keeping the aspect ratio, cropping the
+// excess from the center.  Downscaling in Qt::FastTransformation mode is area averaged.
+QImage scaleImage(const QImage &image, const QSize &requestedSize, bool crop, Qt::TransformationMode mode);
+
+// The weighted row accumulation kernel, exposed for the SIMD implementations.
+// Adds row[i] * weight to accumulator[i] for count bytes.
+typedef void (*AccumulateFunction)(quint32 *accumulator, const uchar *row, int count, quint16 weight);
+
+void accumulateRow(quint32 *accumulator, const uchar *row, int count, quint16 weight);
+#if defined(QT_COMPILER_SUPPORTS_SSE2)
+void accumulateRow_sse2(quint32 *accumulator, const uchar *row, int count, quint16 weight);
+#endif
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+void accumulateRow_avx2(quint32 *accumulator, const uchar *row, int count, quint16 weight);
+#endif
+#if defined(QT_COMPILER_SUPPORTS_NEON)
+void accumulateRow_neon(quint32 *accumulator, const uchar *row, int count, quint16 weight);
+#endif
+
+void scale(const uchar *source, int sourceWidth, int sourceHeight, int sourceStride,
+           uchar *destination, int destinationWidth, int destinationHeight, int destinationStride,
+           AccumulateFunction accumulate);
+
+}
+
+#endif // NEMOIMAGESCALER_P_H
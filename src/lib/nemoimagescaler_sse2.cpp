@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemoimagescaler_p.h"
+
+#if defined(QT_COMPILER_SUPPORTS_SSE2)
+
+#include <emmintrin.h>
+
+void NemoImageScaler::accumulateRow_sse2(quint32 *accumulator, const uchar *row, int count, quint16 weight)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights = _mm_set1_epi16(short(weight));
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        const __m128i low = _mm_unpacklo_epi8(pixels, zero);
+        const __m128i high = _mm_unpackhi_epi8(pixels, zero);
+
+        // Build the 32 bit products from the low and high halves of the 16 bit multiplications.
+        const __m128i lowProductLow = _mm_mullo_epi16(low, weights);
+        const __m128i lowProductHigh = _mm_mulhi_epu16(low, weights);
+        const __m128i highProductLow = _mm_mullo_epi16(high, weights);
+        const __m128i highProductHigh = _mm_mulhi_epu16(high, weights);
+
+        __m128i *sums = reinterpret_cast<__m128i *>(accumulator + i);
+        _mm_storeu_si128(sums, _mm_add_epi32(
+                _mm_loadu_si128(sums), _mm_unpacklo_epi16(lowProductLow, lowProductHigh)));
+        _mm_storeu_si128(sums + 1, _mm_add_epi32(
+                _mm_loadu_si128(sums + 1), _mm_unpackhi_epi16(lowProductLow, lowProductHigh)));
+        _mm_storeu_si128(sums + 2, _mm_add_epi32(
+                _mm_loadu_si128(sums + 2), _mm_unpacklo_epi16(highProductLow, highProductHigh)));
+        _mm_storeu_si128(sums + 3, _mm_add_epi32(
+                _mm_loadu_si128(sums + 3), _mm_unpackhi_epi16(highProductLow, highProductHigh)));
+    }
+
+    accumulateRow(accumulator + i, row + i, count - i, weight);
+}
+
+#endif
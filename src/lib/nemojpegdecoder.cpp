@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemojpegdecoder_p.h"
+#include "nemoimagemetadata.h"
+#include "nemoimagescaler_p.h"
+#include "nemothumbnailtrace_p.h"
+
+#include <QFileDevice>
+#include <QLoggingCategory>
+#include <QRect>
+#include <QTransform>
+
+#include <csetjmp>
+#include <cstdio>
+
+#include <errno.h>
+#include <unistd.h>
+
+extern "C" {
+#include <jpeglib.h>
+#include <jerror.h>
+}
+
+#ifndef JCS_EXTENSIONS
+#error "The JPEG decoder needs libjpeg-turbo, build without HAS_LIBJPEG to use QImageReader"
+#endif
+
+Q_DECLARE_LOGGING_CATEGORY(thumbnailer)
+
+namespace {
+
+struct ErrorManager
+{
+    jpeg_error_mgr manager;
+    std::jmp_buf jump;
+};
+
+void errorExit(j_common_ptr info)
+{
+    ErrorManager *error = reinterpret_cast<ErrorManager *>(info->err);
+
+    char message[JMSG_LENGTH_MAX];
+    (*info->err->format_message)(info, message);
+    qCDebug(thumbnailer) << "libjpeg error:" << message;
+
+    std::longjmp(error->jump, 1);
+}
+
+void outputMessage(j_common_ptr)
+{
+    // Corrupt data warnings are expected from real world files, don't spam the log.
+}
+
+// Reads the file with pread() so the position of the file shared with QImageReader is left
+// alone for the fallback, and unlike a mapping a file truncated while it is read only ends the
+// data early rather than crashing.
+struct SourceManager
+{
+    jpeg_source_mgr manager;
+    int fd;
+    off_t offset;
+    JOCTET buffer[16 * 1024];
+};
+
+void initSource(j_decompress_ptr)
+{
+}
+
+boolean fillInputBuffer(j_decompress_ptr info)
+{
+    SourceManager *source = reinterpret_cast<SourceManager *>(info->src);
+
+    ssize_t length;
+    do {
+        length = ::pread(source->fd, source->buffer, sizeof(source->buffer), source->offset);
+    } while (length < 0 && errno == EINTR);
+
+    if (length <= 0) {
+        // Decode a truncated file as far as it goes, as the stdio source does.
+        WARNMS(info, JWRN_JPEG_EOF);
+        source->buffer[0] = 0xff;
+        source->buffer[1] = JPEG_EOI;
+        length = 2;
+    } else {
+        source->offset += length;
+    }
+
+    source->manager.next_input_byte = source->buffer;
+    source->manager.bytes_in_buffer = length;
+    return TRUE;
+}
+
+void skipInputData(j_decompress_ptr info, long count)
+{
+    SourceManager *source = reinterpret_cast<SourceManager *>(info->src);
+    if (count <= 0) {
+        return;
+    } else if (size_t(count) <= source->manager.bytes_in_buffer) {
+        source->manager.next_input_byte += count;
+        source->manager.bytes_in_buffer -= count;
+    } else {
+        // Skip the rest without reading it, the next fill continues after it.
+        source->offset += count - source->manager.bytes_in_buffer;
+        source->manager.bytes_in_buffer = 0;
+    }
+}
+
+void termSource(j_decompress_ptr)
+{
+}
+
+int scaledDimension(JDIMENSION dimension, int denominator)
+{
+    return (int(dimension) + denominator - 1) / denominator;
+}
+
+// Nothing with a non-trivial destructor may be created between the setjmp() and the end of
+// decoding, all state lives in the caller.
+bool decode(jpeg_decompress_struct *info, ErrorManager *error, const QSize &targetSize, bool crop,
+            Qt::TransformationMode mode, QImage *image, QRect *visibleRect)
+{
+    if (setjmp(error->jump)) {
+        return false;
+    }
+
+    jpeg_read_header(info, TRUE);
+
+    if (info->num_components != 1 && info->num_components != 3) {
+        // CMYK and YCCK can't be converted to RGB by libjpeg.
+        return false;
+    }
+
+    const QSize scaledSize = QSize(info->image_width, info->image_height).scaled(
+                targetSize, crop ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio);
+
+    // Pick the smallest DCT scaled output which still covers the scaled size.
+    info->scale_num = 1;
+    info->scale_denom = 1;
+    for (int denominator = 8; denominator > 1; denominator /= 2) {
+        if (scaledDimension(info->image_width, denominator) >= scaledSize.width()
+                && scaledDimension(info->image_height, denominator) >= scaledSize.height()) {
+            info->scale_denom = denominator;
+            break;
+        }
+    }
+
+    info->out_color_space = JCS_EXT_RGBX;
+    if (mode == Qt::FastTransformation) {
+        info->dct_method = JDCT_IFAST;
+        info->do_fancy_upsampling = FALSE;
+    } else {
+        info->dct_method = JDCT_ISLOW;
+    }
+
+    jpeg_start_decompress(info);
+
+    // When cropping only the centre of the image survives, don't decode the columns and rows
+    // either side of it.
+    JDIMENSION width = info->output_width;
+    JDIMENSION height = info->output_height;
+    if (crop) {
+        width = qMin<JDIMENSION>(width, JDIMENSION(
+                (quint64(width) * targetSize.width() + scaledSize.width() - 1) / scaledSize.width()));
+        height = qMin<JDIMENSION>(height, JDIMENSION(
+                (quint64(height) * targetSize.height() + scaledSize.height() - 1) / scaledSize.height()));
+    }
+    const JDIMENSION left = (info->output_width - width) / 2;
+    const JDIMENSION top = (info->output_height - height) / 2;
+
+    // Horizontal cropping is aligned to iMCU boundaries, so the decoded rows may start before and
+    // end after the visible region.
+    JDIMENSION decodeLeft = left;
+    JDIMENSION decodeWidth = width;
+    if (width < info->output_width) {
+        jpeg_crop_scanline(info, &decodeLeft, &decodeWidth);
+    }
+
+    *image = QImage(info->output_width, height, QImage::Format_RGBX8888);
+    if (image->isNull()) {
+        jpeg_abort_decompress(info);
+        return false;
+    }
+    *visibleRect = QRect(left - decodeLeft, 0, width, height);
+
+    if (top > 0) {
+        jpeg_skip_scanlines(info, top);
+    }
+
+    for (JDIMENSION y = 0; y < height; ++y) {
+        JSAMPROW row = image->scanLine(y);
+        jpeg_read_scanlines(info, &row, 1);
+    }
+
+    if (info->output_scanline < info->output_height) {
+        jpeg_abort_decompress(info);
+    } else {
+        jpeg_finish_decompress(info);
+    }
+    return true;
+}
+
+QImage orientImage(const QImage &image, NemoImageMetadata::Orientation orientation)
+{
+    switch (orientation) {
+    case NemoImageMetadata::TopRight:
+        return image.mirrored(true, false);
+    case NemoImageMetadata::BottomRight:
+        return image.mirrored(true, true);
+    case NemoImageMetadata::BottomLeft:
+        return image.mirrored(false, true);
+    case NemoImageMetadata::LeftTop:
+        return image.transformed(QTransform().rotate(90)).mirrored(true, false);
+    case NemoImageMetadata::RightTop:
+        return image.transformed(QTransform().rotate(90));
+    case NemoImageMetadata::RightBottom:
+        return image.transformed(QTransform().rotate(90)).mirrored(false, true);
+    case NemoImageMetadata::LeftBottom:
+        return image.transformed(QTransform().rotate(270));
+    case NemoImageMetadata::TopLeft:
+    default:
+        return image;
+    }
+}
+
+}
+
+QImage NemoJpegDecoder::read(QFileDevice *file, const QSize &requestedSize, bool crop, Qt::TransformationMode mode)
+{
+    if (requestedSize.isEmpty() || file->handle() < 0) {
+        return QImage();
+    }
+
+    const NemoImageMetadata::Orientation orientation = NemoImageMetadata(file->fileName(), "jpeg").orientation();
+    const QSize targetSize = orientation >= NemoImageMetadata::LeftTop
+            ? requestedSize.transposed()
+            : requestedSize;
+
+    jpeg_decompress_struct info;
+    ErrorManager error;
+    info.err = jpeg_std_error(&error.manager);
+    error.manager.error_exit = errorExit;
+    error.manager.output_message = outputMessage;
+
+    jpeg_create_decompress(&info);
+
+    SourceManager source;
+    source.manager.init_source = initSource;
+    source.manager.fill_input_buffer = fillInputBuffer;
+    source.manager.skip_input_data = skipInputData;
+    source.manager.resync_to_restart = jpeg_resync_to_restart;
+    source.manager.term_source = termSource;
+    source.manager.next_input_byte = nullptr;
+    source.manager.bytes_in_buffer = 0;
+    source.fd = file->handle();
+    source.offset = 0;
+    info.src = &source.manager;
+
+    QImage image;
+    QRect visibleRect;
+    const bool decoded = decode(&info, &error, targetSize, crop, mode, &image, &visibleRect);
+
+    jpeg_destroy_decompress(&info);
+
+    if (!decoded) {
+        return QImage();
+    } else if (visibleRect != image.rect()) {
+        image = image.copy(visibleRect);
+    }
+    NemoThumbnailTrace::mark(NemoThumbnailTrace::Decoded);
+
+    // Finish scaling before rotating so the transformation works on the smaller image.
+    image = orientImage(NemoImageScaler::scaleImage(image, targetSize, crop, mode), orientation);
+    NemoThumbnailTrace::mark(NemoThumbnailTrace::Scaled);
+
+    return image;
+}
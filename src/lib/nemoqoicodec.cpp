@@ -0,0 +1,380 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemoqoicodec_p.h"
+
+#include <QIODevice>
+#include <QStringList>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace {
+
+const char Magic[] = { 'q', 'o', 'i', 'f' };
+const int HeaderLength = 14;
+const uchar Padding[] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+const int PaddingLength = sizeof(Padding);
+const char TextTag[] = { 'q', 'o', 'i', 't' };
+const int TextFooterLength = 4 + sizeof(TextTag);
+
+// Refuse to allocate absurd images from corrupt headers.
+const quint32 MaximumDimension = 16384;
+
+enum {
+    OpIndex = 0x00,
+    OpDiff = 0x40,
+    OpLuma = 0x80,
+    OpRun = 0xc0,
+    OpRgb = 0xfe,
+    OpRgba = 0xff,
+    OpMask = 0xc0
+};
+
+struct Pixel
+{
+    uchar r;
+    uchar g;
+    uchar b;
+    uchar a;
+
+    bool operator ==(const Pixel &other) const
+    {
+        return r == other.r && g == other.g && b == other.b && a == other.a;
+    }
+
+    bool operator !=(const Pixel &other) const { return !(*this == other); }
+
+    int hash() const { return (r * 3 + g * 5 + b * 7 + a * 11) % 64; }
+};
+
+// Returns the length of the text trailer including its footer, or 0 if there is none.
+qint64 textLength(const uchar *data, qint64 size)
+{
+    if (size < HeaderLength + PaddingLength + TextFooterLength
+            || std::memcmp(data + size - sizeof(TextTag), TextTag, sizeof(TextTag)) != 0) {
+        return 0;
+    }
+
+    const qint64 length = qFromBigEndian<quint32>(data + size - TextFooterLength) + TextFooterLength;
+    return length <= size - HeaderLength - PaddingLength ? length : 0;
+}
+
+QMap<QString, QString> decodeText(const char *data, qint64 size)
+{
+    QMap<QString, QString> text;
+
+    const char * const end = data + size;
+    while (data < end) {
+        const char * const keyEnd = static_cast<const char *>(std::memchr(data, 0, end - data));
+        const char * const valueEnd = keyEnd
+                ? static_cast<const char *>(std::memchr(keyEnd + 1, 0, end - keyEnd - 1))
+                : nullptr;
+        if (!valueEnd) {
+            break;
+        }
+
+        text.insert(QString::fromUtf8(data, int(keyEnd - data)),
+                    QString::fromUtf8(keyEnd + 1, int(valueEnd - keyEnd - 1)));
+        data = valueEnd + 1;
+    }
+
+    return text;
+}
+
+inline uchar premultiply(uchar color, uchar alpha)
+{
+    const uint t = color * alpha + 128;
+    return uchar((t + (t >> 8)) >> 8);
+}
+
+}
+
+bool NemoQoiCodec::canRead(QIODevice *device)
+{
+    return device && device->peek(sizeof(Magic)) == QByteArray::fromRawData(Magic, sizeof(Magic));
+}
+
+QImage NemoQoiCodec::read(QIODevice *device)
+{
+    const QByteArray data = device->readAll();
+    return decode(reinterpret_cast<const uchar *>(data.constData()), data.size());
+}
+
+bool NemoQoiCodec::write(QIODevice *device, const QImage &image)
+{
+    const QByteArray data = encode(image);
+    return !data.isEmpty() && device->write(data) == data.size();
+}
+
+QMap<QString, QString> NemoQoiCodec::readText(QIODevice *device)
+{
+    const qint64 position = device->pos();
+    const qint64 size = device->size();
+
+    QByteArray data;
+    if (size >= HeaderLength + PaddingLength + TextFooterLength && device->seek(size - TextFooterLength)) {
+        const QByteArray footer = device->read(TextFooterLength);
+        const qint64 length = footer.size() == TextFooterLength
+                    && std::memcmp(footer.constData() + 4, TextTag, sizeof(TextTag)) == 0
+                ? qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(footer.constData()))
+                : -1;
+        if (length >= 0 && length <= size - HeaderLength - PaddingLength - TextFooterLength
+                && device->seek(size - TextFooterLength - length)) {
+            data = device->read(length);
+        }
+    }
+
+    device->seek(position);
+
+    return decodeText(data.constData(), data.size());
+}
+
+QImage NemoQoiCodec::decode(const uchar *data, qint64 size)
+{
+    if (size < HeaderLength + PaddingLength || std::memcmp(data, Magic, sizeof(Magic)) != 0) {
+        return QImage();
+    }
+
+    const qint64 trailerLength = textLength(data, size);
+    size -= trailerLength;
+
+    const quint32 width = qFromBigEndian<quint32>(data + 4);
+    const quint32 height = qFromBigEndian<quint32>(data + 8);
+    const int channels = data[12];
+    if (width == 0 || height == 0 || width > MaximumDimension || height > MaximumDimension
+            || (channels != 3 && channels != 4)) {
+        return QImage();
+    }
+
+    QImage image(width, height, channels == 4
+            ? QImage::Format_RGBA8888_Premultiplied
+            : QImage::Format_RGBX8888);
+    if (image.isNull()) {
+        return QImage();
+    }
+
+    Pixel index[64];
+    std::memset(index, 0, sizeof(index));
+
+    Pixel pixel = { 0, 0, 0, 255 };
+    int run = 0;
+
+    const uchar *in = data + HeaderLength;
+    const uchar * const end = data + size - PaddingLength;
+
+    for (quint32 y = 0; y < height; ++y) {
+        uchar *out = image.scanLine(y);
+        for (quint32 x = 0; x < width; ++x, out += 4) {
+            if (run > 0) {
+                --run;
+            } else if (in < end) {
+                const uchar op = *in++;
+                if (op == OpRgb) {
+                    if (end - in < 3) {
+                        return QImage();
+                    }
+                    pixel.r = in[0];
+                    pixel.g = in[1];
+                    pixel.b = in[2];
+                    in += 3;
+                } else if (op == OpRgba) {
+                    if (end - in < 4) {
+                        return QImage();
+                    }
+                    pixel.r = in[0];
+                    pixel.g = in[1];
+                    pixel.b = in[2];
+                    pixel.a = in[3];
+                    in += 4;
+                } else if ((op & OpMask) == OpIndex) {
+                    pixel = index[op];
+                } else if ((op & OpMask) == OpDiff) {
+                    pixel.r += ((op >> 4) & 0x03) - 2;
+                    pixel.g += ((op >> 2) & 0x03) - 2;
+                    pixel.b += (op & 0x03) - 2;
+                } else if ((op & OpMask) == OpLuma) {
+                    if (end - in < 1) {
+                        return QImage();
+                    }
+                    const int greenDifference = (op & 0x3f) - 32;
+                    const uchar next = *in++;
+                    pixel.r += greenDifference - 8 + ((next >> 4) & 0x0f);
+                    pixel.g += greenDifference;
+                    pixel.b += greenDifference - 8 + (next & 0x0f);
+                } else {
+                    run = op & 0x3f;
+                }
+
+                index[pixel.hash()] = pixel;
+            } else {
+                // Truncated data.
+                return QImage();
+            }
+
+            if (channels == 4 && pixel.a != 255) {
+                out[0] = premultiply(pixel.r, pixel.a);
+                out[1] = premultiply(pixel.g, pixel.a);
+                out[2] = premultiply(pixel.b, pixel.a);
+                out[3] = pixel.a;
+            } else {
+                out[0] = pixel.r;
+                out[1] = pixel.g;
+                out[2] = pixel.b;
+                out[3] = 255;
+            }
+        }
+    }
+
+    if (trailerLength > 0) {
+        const QMap<QString, QString> text = decodeText(
+                    reinterpret_cast<const char *>(data + size), trailerLength - TextFooterLength);
+        for (auto it = text.cbegin(); it != text.cend(); ++it) {
+            image.setText(it.key(), it.value());
+        }
+    }
+
+    return image;
+}
+
+QByteArray NemoQoiCodec::encode(const QImage &image)
+{
+    if (image.isNull()) {
+        return QByteArray();
+    }
+
+    const bool alpha = image.hasAlphaChannel();
+    const int channels = alpha ? 4 : 3;
+    const QImage source = image.convertToFormat(alpha ? QImage::Format_RGBA8888 : QImage::Format_RGBX8888);
+
+    const quint32 width = source.width();
+    const quint32 height = source.height();
+
+    QByteArray data;
+    data.resize(HeaderLength + int(width * height * (channels + 1)) + PaddingLength);
+
+    uchar * const begin = reinterpret_cast<uchar *>(data.data());
+    uchar *out = begin;
+
+    std::memcpy(out, Magic, sizeof(Magic));
+    qToBigEndian<quint32>(width, out + 4);
+    qToBigEndian<quint32>(height, out + 8);
+    out[12] = uchar(channels);
+    out[13] = 0;    // sRGB with linear alpha
+    out += HeaderLength;
+
+    Pixel index[64];
+    std::memset(index, 0, sizeof(index));
+
+    Pixel previous = { 0, 0, 0, 255 };
+    int run = 0;
+
+    for (quint32 y = 0; y < height; ++y) {
+        const uchar *in = source.constScanLine(y);
+        for (quint32 x = 0; x < width; ++x, in += 4) {
+            const Pixel pixel = { in[0], in[1], in[2], alpha ? in[3] : uchar(255) };
+
+            if (pixel == previous) {
+                if (++run == 62) {
+                    *out++ = uchar(OpRun | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0) {
+                *out++ = uchar(OpRun | (run - 1));
+                run = 0;
+            }
+
+            const int hash = pixel.hash();
+            if (index[hash] == pixel) {
+                *out++ = uchar(OpIndex | hash);
+            } else {
+                index[hash] = pixel;
+
+                if (pixel.a == previous.a) {
+                    const qint8 dr = qint8(pixel.r - previous.r);
+                    const qint8 dg = qint8(pixel.g - previous.g);
+                    const qint8 db = qint8(pixel.b - previous.b);
+                    const qint8 drg = qint8(dr - dg);
+                    const qint8 dbg = qint8(db - dg);
+
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        *out++ = uchar(OpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                    } else if (drg >= -8 && drg <= 7 && dg >= -32 && dg <= 31 && dbg >= -8 && dbg <= 7) {
+                        *out++ = uchar(OpLuma | (dg + 32));
+                        *out++ = uchar((drg + 8) << 4 | (dbg + 8));
+                    } else {
+                        *out++ = OpRgb;
+                        *out++ = pixel.r;
+                        *out++ = pixel.g;
+                        *out++ = pixel.b;
+                    }
+                } else {
+                    *out++ = OpRgba;
+                    *out++ = pixel.r;
+                    *out++ = pixel.g;
+                    *out++ = pixel.b;
+                    *out++ = pixel.a;
+                }
+            }
+            previous = pixel;
+        }
+    }
+
+    if (run > 0) {
+        *out++ = uchar(OpRun | (run - 1));
+    }
+
+    std::memcpy(out, Padding, PaddingLength);
+    out += PaddingLength;
+
+    data.resize(int(out - begin));
+
+    const QStringList keys = image.textKeys();
+    if (!keys.isEmpty()) {
+        QByteArray text;
+        for (const QString &key : keys) {
+            text += key.toUtf8() + '\0' + image.text(key).toUtf8() + '\0';
+        }
+
+        char length[4];
+        qToBigEndian<quint32>(text.size(), reinterpret_cast<uchar *>(length));
+
+        data += text;
+        data.append(length, sizeof(length));
+        data.append(TextTag, sizeof(TextTag));
+    }
+
+    return data;
+}
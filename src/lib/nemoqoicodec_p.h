@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef NEMOQOICODEC_P_H
+#define NEMOQOICODEC_P_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QMap>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+// Codec for the "Quite OK Image" format, a lossless format which encodes and decodes many
+// times faster than PNG at a similar size for thumbnail sized images.
+//
+// Opaque images are stored with three channels and decode to QImage::Format_RGBX8888, images
+// with an alpha channel decode straight to QImage::Format_RGBA8888_Premultiplied.
+//
+// The text of an image is stored in a trailer after the end of the QOI data, which other
+// decoders ignore.  The trailer is a sequence of nul terminated UTF-8 keys and values followed
+// by the quint32 big endian length of the sequence and the tag "qoit".
+
+namespace NemoQoiCodec {
+
+// Reading starts from the current position of an open device.
+bool canRead(QIODevice *device);
+
+QImage read(QIODevice *device);
+bool write(QIODevice *device, const QImage &image);
+
+// Reads only the text trailer of an image on a random access device.
+QMap<QString, QString> readText(QIODevice *device);
+
+QImage decode(const uchar *data, qint64 size);
+QByteArray encode(const QImage &image);
+
+}
+
+#endif // NEMOQOICODEC_P_H
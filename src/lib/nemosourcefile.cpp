@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include "nemosourcefile_p.h"
+
+#include <QFile>
+#include <QVarLengthArray>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// True if any page of the file is already in the page cache, for example because it is being
+// shown by an application.
+bool residentPages(void *data, qint64 size)
+{
+    const long pageSize = ::sysconf(_SC_PAGESIZE);
+    QVarLengthArray<unsigned char, 4096> pages((size + pageSize - 1) / pageSize);
+    if (::mincore(data, size, pages.data()) != 0) {
+        return true;
+    }
+
+    for (unsigned char page : pages) {
+        if (page & 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+NemoSourceFile::NemoSourceFile(const QString &path)
+    : m_fd(::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC))
+{
+    struct stat status;
+    if (m_fd < 0 || ::fstat(m_fd, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0) {
+        return;
+    }
+
+    // Residency can only be checked through a mapping, which costs nothing as it is never read.
+    void *data = ::mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED) {
+        // Without knowing leave the page cache alone.
+        m_cached = true;
+    } else {
+        m_cached = residentPages(data, status.st_size);
+        ::munmap(data, status.st_size);
+    }
+
+    ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_WILLNEED);
+}
+
+NemoSourceFile::~NemoSourceFile()
+{
+    if (m_fd >= 0) {
+        if (!m_cached) {
+            ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+        ::close(m_fd);
+    }
+}
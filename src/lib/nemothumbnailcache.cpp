@@ -33,7 +33,6 @@
 #include <QLibrary>
 #include <QFile>
 #include <QUrl>
-#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
 #include <QImageReader>
@@ -46,18 +45,36 @@
 #endif
 #include <QStandardPaths>
 #include <QProcess>
-#include <QThreadStorage>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <signal.h>
 
 #include <QtGui/private/qimage_p.h>
 
 #include "nemothumbnailcache.h"
+#include "nemobatchstat_p.h"
+#include "nemoimagealpha_p.h"
+#include "nemoimagescaler_p.h"
+#include "nemoqoicodec_p.h"
+#include "nemosourcefile_p.h"
+#ifdef HAS_LIBJPEG
+#include "nemojpegdecoder_p.h"
+#endif
+#include "nemothumbnaildaemonclient_p.h"
+#include "nemothumbnailgenerators_p.h"
+#include "nemothumbnailprotocol_p.h"
+#include "nemothumbnailtrace_p.h"
+#include "nemothumbnailwriter_p.h"
 
 Q_LOGGING_CATEGORY(thumbnailer, "Nemo.Thumbnailer", QtWarningMsg)
 
 namespace {
 
-template <typename T, int N> constexpr int lengthOf(const T(&)[N]) { return N; }
-
 bool acceptableUnboundedSize(const QSize &requestedSize, bool crop, unsigned maxSize)
 {
     const bool sufficientWidth = (unsigned) requestedSize.width() <= maxSize;
@@ -66,21 +83,17 @@ bool acceptableUnboundedSize(const QSize &requestedSize, bool crop, unsigned max
                 : (sufficientWidth || sufficientHeight);
 }
 
-unsigned selectUnboundedSize(const QSize &requestedSize, unsigned screenWidth, unsigned screenHeight, bool crop)
+unsigned selectUnboundedSize(const QSize &requestedSize, const QVector<unsigned> &sizes, bool crop)
 {
     // Prefer a thumbnail size at least as large as the requested size
-    const unsigned candidates[] = { NemoThumbnailCache::Small, NemoThumbnailCache::Medium, NemoThumbnailCache::Large,
-                                    NemoThumbnailCache::ExtraLarge, screenWidth};
-    for (unsigned i = 0; i < lengthOf(candidates); ++i) {
-        if (acceptableUnboundedSize(requestedSize, crop, candidates[i])) {
-            return candidates[i];
+    for (unsigned size : sizes) {
+        if (acceptableUnboundedSize(requestedSize, crop, size)) {
+            return size;
         }
     }
-    if (!acceptableUnboundedSize(requestedSize, crop, screenHeight)) {
-        qCWarning(thumbnailer) << Q_FUNC_INFO << "Invalid thumbnail size"
-                               << requestedSize << "requested; using:" << screenHeight;
-    }
-    return screenHeight;
+    qCWarning(thumbnailer) << Q_FUNC_INFO << "Invalid thumbnail size"
+                           << requestedSize << "requested; using:" << sizes.last();
+    return sizes.last();
 }
 
 bool acceptableBoundedSize(const QSize &requestedSize, unsigned size)
@@ -90,65 +103,81 @@ bool acceptableBoundedSize(const QSize &requestedSize, unsigned size)
     return manageableWidth && manageableHeight;
 }
 
-unsigned selectBoundedSize(const QSize &requestedSize, unsigned screenWidth, unsigned screenHeight)
+unsigned selectBoundedSize(const QSize &requestedSize, const QVector<unsigned> &sizes)
 {
     // Select a size that does not exceed the requested size
-    const unsigned candidates[] = { screenHeight, screenWidth, NemoThumbnailCache::ExtraLarge,
-                                    NemoThumbnailCache::Large, NemoThumbnailCache::Medium };
-    for (unsigned i = 0; i < lengthOf(candidates); ++i) {
-        if (acceptableBoundedSize(requestedSize, candidates[i])) {
-            return candidates[i];
+    for (int i = sizes.count() - 1; i > 0; --i) {
+        if (acceptableBoundedSize(requestedSize, sizes.at(i))) {
+            return sizes.at(i);
         }
     }
-    if (!acceptableBoundedSize(requestedSize, NemoThumbnailCache::Small)) {
+    if (!acceptableBoundedSize(requestedSize, sizes.first())) {
         qCWarning(thumbnailer) << Q_FUNC_INFO << "Invalid thumbnail size" << requestedSize << "requested; using:"
-                               << NemoThumbnailCache::Small;
+                               << sizes.first();
     }
-    return NemoThumbnailCache::Small;
+    return sizes.first();
 }
 
-unsigned selectSize(const QSize &requestedSize, unsigned screenWidth, unsigned screenHeight, bool crop, bool unbounded)
+unsigned selectSize(const QSize &requestedSize, const QVector<unsigned> &sizes, bool crop, bool unbounded)
 {
     return unbounded
-            ? selectUnboundedSize(requestedSize, screenWidth, screenHeight, crop)
-            : selectBoundedSize(requestedSize, screenWidth, screenHeight);
+            ? selectUnboundedSize(requestedSize, sizes, crop)
+            : selectBoundedSize(requestedSize, sizes);
 }
 
-unsigned increaseSize(unsigned size, unsigned screenWidth, unsigned screenHeight)
+QVector<unsigned> configuredSizes()
 {
-    const unsigned candidates[] = { NemoThumbnailCache::Small, NemoThumbnailCache::Medium, NemoThumbnailCache::Large,
-                                    NemoThumbnailCache::ExtraLarge, screenWidth, screenHeight };
-    for (unsigned i = 0; i < lengthOf(candidates) - 1; ++i) {
-        if (candidates[i] == size) {
-            return candidates[i] + 1;
+    QVariant sizes;
+    QVariant pixelRatio;
+
+    const QByteArray environmentSizes = qgetenv("NEMO_THUMBNAILER_SIZES");
+    if (!environmentSizes.isEmpty()) {
+        QVariantList sizeList;
+        for (const QByteArray &size : environmentSizes.split(',')) {
+            sizeList.append(QString::fromLatin1(size.trimmed()));
         }
+        sizes = sizeList;
     }
-    return NemoThumbnailCache::None;
-}
+    const QByteArray environmentPixelRatio = qgetenv("NEMO_THUMBNAILER_PIXEL_RATIO");
+    if (!environmentPixelRatio.isEmpty()) {
+        pixelRatio = QString::fromLatin1(environmentPixelRatio);
+    }
+#ifdef HAS_MLITE5
+    if (!sizes.isValid()) {
+        sizes = MGConfItem(QStringLiteral("/desktop/nemo/thumbnailer/sizes")).value();
+    }
+    if (!pixelRatio.isValid()) {
+        pixelRatio = MGConfItem(QStringLiteral("/desktop/nemo/thumbnailer/pixel_ratio")).value();
+    }
+#endif
 
-unsigned decreaseSize(unsigned size, unsigned screenWidth, unsigned screenHeight)
-{
-    const unsigned candidates[] = { screenHeight, screenWidth, NemoThumbnailCache::ExtraLarge, NemoThumbnailCache::Large,
-                                    NemoThumbnailCache::Medium, NemoThumbnailCache::Small };
-    for (unsigned i = 0; i < lengthOf(candidates) - 1; ++i) {
-        if (candidates[i] == size) {
-            return candidates[i] + 1;
+    QVector<unsigned> ladder;
+    const QVariantList sizeList = sizes.toList();
+    for (const QVariant &size : sizeList) {
+        bool ok = false;
+        const unsigned value = size.toUInt(&ok);
+        if (ok && value > 0) {
+            ladder.append(value);
+        } else {
+            qCWarning(thumbnailer) << "Ignoring invalid thumbnail size" << size;
         }
     }
-    return NemoThumbnailCache::None;
-}
+    if (ladder.isEmpty()) {
+        ladder = { NemoThumbnailCache::Small, NemoThumbnailCache::Medium, NemoThumbnailCache::Large,
+                   NemoThumbnailCache::ExtraLarge };
+    }
 
-unsigned nextSize(unsigned size, unsigned screenWidth, unsigned screenHeight, bool unbounded)
-{
-    return unbounded
-            ? increaseSize(size, screenWidth, screenHeight)
-            : decreaseSize(size, screenWidth, screenHeight);
-}
+    // Sizes are given in logical pixels, scale them to the device and round to a multiple of
+    // 16 so they remain friendly to decoders which scale by powers of two.
+    bool ok = false;
+    const qreal ratio = pixelRatio.toReal(&ok);
+    if (ok && ratio > 0 && !qFuzzyCompare(ratio, qreal(1))) {
+        for (unsigned &size : ladder) {
+            size = qMax(16u, (unsigned(size * ratio) + 8) / 16 * 16);
+        }
+    }
 
-inline QString thumbnailsCachePath()
-{
-    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
-            + QLatin1String("/org.nemomobile/thumbnails");
+    return ladder;
 }
 
 QString cachePath(const QString &thumbnailsCachePath, const QByteArray &key, bool makePath = false)
@@ -165,18 +194,118 @@ QString cachePath(const QString &thumbnailsCachePath, const QByteArray &key, boo
 
 QByteArray cacheKey(const QString &id, unsigned size, bool crop)
 {
-    const QByteArray baId = id.toUtf8(); // is there a more efficient way than a copy?
+    return NemoThumbnailProtocol::sourceHash(id) + "-" + QString::number(size).toLatin1() + (crop ? "" : "F");
+}
+
+// Strips are keyed by their frame count and the bounds of each frame, which are rounded up so
+// similar requests share an entry.
+const int MaximumStripFrames = 64;
+// Frames are laid out in rows of this many so a strip is at most 4096 pixels wide and 1024
+// high, which is within the maximum texture size of every supported GPU.
+const int MaximumStripColumns = 16;
+
+int stripColumns(int frames)
+{
+    return qMin(frames, MaximumStripColumns);
+}
+
+int stripRows(int frames)
+{
+    return (frames + MaximumStripColumns - 1) / MaximumStripColumns;
+}
+
+unsigned stripSize(const QSize &frameSize)
+{
+    return qBound(16, (qMax(frameSize.width(), frameSize.height()) + 15) / 16 * 16,
+                  int(NemoThumbnailCache::Medium));
+}
+
+QByteArray stripKey(const QString &id, int frames, unsigned size)
+{
+    return NemoThumbnailProtocol::sourceHash(id) + "-s" + QByteArray::number(frames)
+            + "x" + QByteArray::number(size) + "F";
+}
 
-    QCryptographicHash hash(QCryptographicHash::Sha1);
-    hash.addData(baId.constData(), baId.length());
-    return hash.result().toHex() + "-" + QString::number(size).toLatin1() + (crop ? "" : "F");
+bool validStrip(const QString &path, int frames, const QSize &frameSize)
+{
+    return !path.isEmpty() && frames > 0 && frames <= MaximumStripFrames && !frameSize.isEmpty();
 }
 
+// Directories watched by the daemon, whose cache entries are removed when their source changes
+// so they needn't be compared against the source on every lookup.
+class WatchedDirectories
+{
+public:
+    bool contains(const QString &thumbnailsCachePath, const QString &path)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (!m_refreshTimer.isValid() || m_refreshTimer.hasExpired(RefreshInterval)) {
+            m_refreshTimer.start();
+            refresh(thumbnailsCachePath);
+        }
+
+        for (const QString &directory : m_directories) {
+            if (path.startsWith(directory)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    enum { RefreshInterval = 5000 };
+
+    void refresh(const QString &thumbnailsCachePath)
+    {
+        QFile file(NemoThumbnailProtocol::watchStatePath(thumbnailsCachePath));
+        const QDateTime modified = QFileInfo(file).lastModified();
+        if (modified == m_modified && (m_directories.isEmpty() || daemonRunning())) {
+            return;
+        }
+
+        m_modified = modified;
+        m_directories.clear();
+
+        // The state is only valid while the daemon which wrote it is running.
+        if (!file.open(QIODevice::ReadOnly)
+                || file.readLine().trimmed() != NemoThumbnailProtocol::bootId()) {
+            return;
+        }
+        m_pid = file.readLine().trimmed().toInt();
+        if (!daemonRunning()) {
+            return;
+        }
+
+        while (!file.atEnd()) {
+            const QString directory = QFile::decodeName(file.readLine().trimmed());
+            if (!directory.isEmpty()) {
+                m_directories.append(directory + QLatin1Char('/'));
+            }
+        }
+    }
+
+    bool daemonRunning() const
+    {
+        return m_pid > 0 && (::kill(m_pid, 0) == 0 || errno == EPERM);
+    }
+
+    QMutex m_mutex;
+    QElapsedTimer m_refreshTimer;
+    QDateTime m_modified;
+    QStringList m_directories;
+    pid_t m_pid = 0;
+};
+
+Q_GLOBAL_STATIC(WatchedDirectories, watchedDirectories)
+
 QString attemptCachedServe(const QString &thumbnailsCachePath, const QString &id, const QByteArray &key)
 {
     QFile fi(cachePath(thumbnailsCachePath, key));
     QFileInfo info(fi);
-    if (info.exists() && info.lastModified() >= QFileInfo(id).lastModified()) {
+    if (info.exists()
+            && (watchedDirectories->contains(thumbnailsCachePath, id)
+                || info.lastModified() >= QFileInfo(id).lastModified())) {
         if (fi.open(QIODevice::ReadOnly)) {
             // cached file exists! hooray.
             return fi.fileName();
@@ -186,6 +315,29 @@ QString attemptCachedServe(const QString &thumbnailsCachePath, const QString &id
     return QString();
 }
 
+NemoThumbnailCache::ThumbnailData existingEntry(const QString &thumbnailsCachePath, const QString &path,
+                                                unsigned size, bool crop, bool placeholder)
+{
+    const QByteArray key = cacheKey(path, size, crop);
+
+    // Recently generated thumbnails may not have been written to disk yet.
+    if (NemoThumbnailWriter *writer = NemoThumbnailWriter::instance()) {
+        bool written = false;
+        const QImage image = writer->pendingImage(cachePath(thumbnailsCachePath, key), path, &written);
+        if (!image.isNull()) {
+            return NemoThumbnailCache::ThumbnailData(
+                        written ? cachePath(thumbnailsCachePath, key) : QString(), image, size, placeholder);
+        }
+    }
+
+    const QString thumbnailPath = attemptCachedServe(thumbnailsCachePath, path, key);
+    if (!thumbnailPath.isEmpty()) {
+        return NemoThumbnailCache::ThumbnailData(thumbnailPath, QImage(), size, placeholder);
+    }
+
+    return NemoThumbnailCache::ThumbnailData();
+}
+
 QString imagePath(const QString &uri)
 {
     if (uri.startsWith("file://")) {
@@ -195,20 +347,22 @@ QString imagePath(const QString &uri)
     }
 }
 
-QImage scaleImage(const QImage &image, const QSize &requestedSize, bool crop, Qt::TransformationMode mode)
+QImage readUnscaledImage(QImageReader *reader, const QSize &requestedSize, bool crop)
 {
-    const QImage scaledImage(image.size() != requestedSize
-            ? image.scaled(requestedSize, crop ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio, mode)
-            : image);
-
-    if (crop && scaledImage.size() != requestedSize) {
-        QRect cropRect(0, 0, requestedSize.width(), requestedSize.height());
-        cropRect.moveCenter(QPoint(scaledImage.width() / 2, scaledImage.height() / 2));
+    reader->setAutoTransform(true);
 
-        return scaledImage.copy(cropRect);
-    } else {
-        return scaledImage;
+    QImage image(reader->read());
+    NemoThumbnailTrace::mark(NemoThumbnailTrace::Decoded);
+    if (crop && !image.isNull()) {
+        QRect cropRect(QPoint(0, 0), image.size().boundedTo(requestedSize));
+        cropRect.moveCenter(image.rect().center());
+        if (cropRect != image.rect()) {
+            image = image.copy(cropRect);
+        }
     }
+    NemoThumbnailTrace::mark(NemoThumbnailTrace::Scaled);
+
+    return image;
 }
 
 QStringList generatorArgs(const QString &path, const QString &thumbnailPath, const QSize &requestedSize, bool crop)
@@ -258,6 +412,46 @@ NemoThumbnailCache::ThumbnailData generatePdfThumbnail(const QString &thumbnails
     return NemoThumbnailCache::ThumbnailData();
 }
 
+// Returns true if a strip image has the layout of frames scaled to fit within size.  A helper
+// which doesn't know the frame count option writes a single frame instead.
+bool validStripLayout(const QSize &stripSize, int frames, int size)
+{
+    const int columns = stripColumns(frames);
+    const int rows = stripRows(frames);
+    const int width = stripSize.width() / columns;
+    const int height = stripSize.height() / rows;
+
+    return width > 0 && height > 0
+            && width * columns == stripSize.width()
+            && height * rows == stripSize.height()
+            && qMax(width, height) == size;
+}
+
+// Given a frame count the helper scales each frame to fit within the requested size and writes
+// them left to right in rows of stripColumns() frames into a single image.
+NemoThumbnailCache::ThumbnailData generateVideoStrip(const QString &thumbnailsCachePath, const QString &path,
+                                                     const QByteArray &key, int frames, unsigned size)
+{
+    const QString thumbnailPath(cachePath(thumbnailsCachePath, key, true));
+
+    QStringList args = generatorArgs(path, thumbnailPath, QSize(size, size), false);
+    args << QStringLiteral("-n") << QString::number(frames);
+
+    int rv = QProcess::execute(QStringLiteral("/usr/bin/thumbnaild-video"), args);
+    if (rv == 0) {
+        if (!validStripLayout(QImageReader(thumbnailPath).size(), frames, size)) {
+            qCWarning(thumbnailer) << Q_FUNC_INFO << "thumbnaild-video didn't write a strip:" << path << frames;
+            QFile::remove(thumbnailPath);
+            return NemoThumbnailCache::ThumbnailData();
+        }
+        return NemoThumbnailCache::ThumbnailData(thumbnailPath, QImage(), size);
+    } else {
+        qCWarning(thumbnailer) << Q_FUNC_INFO << "Could not generateVideoStrip:" << path << frames << size;
+    }
+
+    return NemoThumbnailCache::ThumbnailData();
+}
+
 class ConversionImage : public QImage
 {
 public:
@@ -284,24 +478,85 @@ class NemoThumbnailCacheInstance : public NemoThumbnailCache
 {
 public:
     NemoThumbnailCacheInstance()
-        : NemoThumbnailCache(thumbnailsCachePath())
+        : NemoThumbnailCache(NemoThumbnailProtocol::cachePath())
     {
     }
 };
 
-static QThreadStorage<NemoThumbnailCacheInstance> cacheInstance;
+Q_GLOBAL_STATIC(NemoThumbnailCacheInstance, cacheInstance)
+
+// Thumbnails currently being generated, so a request for a thumbnail another thread is already
+// generating waits for that result instead of decoding the original again.
+class InFlightGenerations
+{
+public:
+    // Returns false if the calling thread should generate the thumbnail and call finish() once
+    // done, otherwise waits for the thread generating it and returns its result in thumbnail.
+    bool join(const QString &thumbnailPath, NemoThumbnailCache::ThumbnailData *thumbnail)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        Generation *generation = m_generations.value(thumbnailPath);
+        if (!generation) {
+            m_generations.insert(thumbnailPath, new Generation);
+            return false;
+        }
+
+        ++generation->waiters;
+        while (!generation->finished) {
+            generation->condition.wait(&m_mutex);
+        }
+
+        *thumbnail = generation->thumbnail;
+        if (--generation->waiters == 0) {
+            delete generation;
+        }
+        return true;
+    }
+
+    void finish(const QString &thumbnailPath, const NemoThumbnailCache::ThumbnailData &thumbnail)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        Generation *generation = m_generations.take(thumbnailPath);
+        if (generation->waiters == 0) {
+            delete generation;
+        } else {
+            generation->thumbnail = thumbnail;
+            generation->finished = true;
+            generation->condition.wakeAll();
+        }
+    }
+
+private:
+    struct Generation
+    {
+        QWaitCondition condition;
+        NemoThumbnailCache::ThumbnailData thumbnail;
+        int waiters = 0;
+        bool finished = false;
+    };
+
+    QMutex m_mutex;
+    QHash<QString, Generation *> m_generations;
+};
+
+Q_GLOBAL_STATIC(InFlightGenerations, inFlightGenerations)
 
 }
 
 NemoThumbnailCache::ThumbnailData::ThumbnailData()
     : size_(NemoThumbnailCache::None)
+    , placeholder_(false)
 {
 }
 
-NemoThumbnailCache::ThumbnailData::ThumbnailData(const QString &path, const QImage &image, unsigned size)
+NemoThumbnailCache::ThumbnailData::ThumbnailData(const QString &path, const QImage &image, unsigned size,
+                                                 bool placeholder)
     : path_(path)
     , image_(image)
     , size_(size)
+    , placeholder_(placeholder)
 {
 }
 
@@ -330,15 +585,61 @@ unsigned NemoThumbnailCache::ThumbnailData::size() const
     return size_;
 }
 
+bool NemoThumbnailCache::ThumbnailData::placeholder() const
+{
+    return placeholder_;
+}
+
 QImage NemoThumbnailCache::ThumbnailData::getScaledImage(const QSize &requestedSize, bool crop,
                                                          Qt::TransformationMode mode) const
 {
     if (!image_.isNull()) {
-        return scaleImage(image_, requestedSize, crop, mode);
+        NemoThumbnailTrace::mark(NemoThumbnailTrace::Decoded);
+        QImage image = NemoImageScaler::scaleImage(image_, requestedSize, crop, mode);
+        NemoThumbnailTrace::mark(NemoThumbnailTrace::Scaled);
+        return image;
     } else if (!path_.isEmpty()) {
         QImageReader reader(path_);
 
-        QImage image = readImageThumbnail(&reader, requestedSize, crop, mode);
+        // Cache entries may be QOI which QImageReader can only read if the image format plugin
+        // is installed, and which is faster to read directly anyway.
+        QImage image;
+        const QByteArray format = reader.format();
+        QIODevice *device = reader.device();
+        if ((format.isEmpty() || format == "qoi")
+                && device
+                && (device->isOpen() || device->open(QIODevice::ReadOnly))
+                && device->seek(0)
+                && NemoQoiCodec::canRead(device)) {
+            image = NemoQoiCodec::read(device);
+            NemoThumbnailTrace::mark(NemoThumbnailTrace::Decoded);
+            image = NemoImageScaler::scaleImage(image, requestedSize, crop, mode);
+            NemoThumbnailTrace::mark(NemoThumbnailTrace::Scaled);
+        } else {
+            image = readImageThumbnail(&reader, requestedSize, crop, mode);
+        }
+
+        optimizeImageForTexture(&image);
+
+        return image;
+    } else {
+        return QImage();
+    }
+}
+
+QImage NemoThumbnailCache::ThumbnailData::getImage() const
+{
+    if (!image_.isNull()) {
+        return image_;
+    } else if (!path_.isEmpty()) {
+        QImage image;
+        QFile file(path_);
+        if (file.open(QIODevice::ReadOnly) && NemoQoiCodec::canRead(&file)) {
+            image = NemoQoiCodec::read(&file);
+        } else {
+            image = QImageReader(path_).read();
+        }
+        NemoThumbnailTrace::mark(NemoThumbnailTrace::Decoded);
 
         optimizeImageForTexture(&image);
 
@@ -352,22 +653,32 @@ static unsigned int MaximumSaneSize = 6000;
 
 NemoThumbnailCache::NemoThumbnailCache(const QString &cachePath)
     : cachePath_(cachePath)
+    , sizes_(configuredSizes())
+{
 #ifdef HAS_MLITE5
-    , screenWidth_(MGConfItem(QStringLiteral("/lipstick/screen/primary/width")).value(540).toInt())
-    , screenHeight_(MGConfItem(QStringLiteral("/lipstick/screen/primary/height")).value(960).toInt())
+    unsigned screenWidth = MGConfItem(QStringLiteral("/lipstick/screen/primary/width")).value(540).toInt();
+    unsigned screenHeight = MGConfItem(QStringLiteral("/lipstick/screen/primary/height")).value(960).toInt();
 #else
-    , screenWidth_(540)
-    , screenHeight_(960)
+    unsigned screenWidth = 540;
+    unsigned screenHeight = 960;
 #endif
-{
-    if (screenWidth_ > screenHeight_) {
-        std::swap(screenWidth_, screenHeight_);
+    if (screenWidth > screenHeight) {
+        std::swap(screenWidth, screenHeight);
     }
 
-    if (screenWidth_ > MaximumSaneSize || screenHeight_ > MaximumSaneSize) {
+    if (screenWidth > MaximumSaneSize || screenHeight > MaximumSaneSize) {
         qWarning() << "Invalid screen dimensions, capping to" << MaximumSaneSize;
-        screenWidth_ = std::min(screenWidth_, MaximumSaneSize);
-        screenHeight_ = std::min(screenHeight_, MaximumSaneSize);
+        screenWidth = std::min(screenWidth, MaximumSaneSize);
+        screenHeight = std::min(screenHeight, MaximumSaneSize);
+    }
+
+    // The largest buckets are always the screen dimensions.
+    sizes_.append(screenWidth);
+    sizes_.append(screenHeight);
+    std::sort(sizes_.begin(), sizes_.end());
+    sizes_.erase(std::unique(sizes_.begin(), sizes_.end()), sizes_.end());
+    while (sizes_.last() > screenHeight) {
+        sizes_.removeLast();
     }
 
     QDir directory(cachePath_);
@@ -382,7 +693,12 @@ NemoThumbnailCache::~NemoThumbnailCache()
 
 NemoThumbnailCache *NemoThumbnailCache::instance()
 {
-    return &cacheInstance.localData();
+    return cacheInstance();
+}
+
+void NemoThumbnailCache::setClientPriority(ClientPriority priority)
+{
+    NemoThumbnailDaemonClient::setPriority(priority);
 }
 
 NemoThumbnailCache::ThumbnailData NemoThumbnailCache::requestThumbnail(const QString &uri, const QSize &requestedSize,
@@ -391,14 +707,28 @@ NemoThumbnailCache::ThumbnailData NemoThumbnailCache::requestThumbnail(const QSt
     const QString path(imagePath(uri));
     if (!path.isEmpty()) {
         ThumbnailData existing(existingThumbnail(uri, requestedSize, crop, unbounded));
-        if (existing.validPath()) {
+        if ((existing.validPath() || existing.validImage()) && !existing.placeholder()) {
             return existing;
         }
 
-        const unsigned size = selectSize(requestedSize, screenWidth_, screenHeight_, crop, unbounded);
+        const unsigned size = selectSize(requestedSize, sizes_, crop, unbounded);
         if (size != None) {
             const QByteArray key = cacheKey(path, size, crop);
-            return generateThumbnail(path, key, size, crop, mimeType);
+            const QString generationId = cachePath(cachePath_, key);
+
+            ThumbnailData thumbnail;
+            if (inFlightGenerations->join(generationId, &thumbnail)) {
+                return thumbnail;
+            }
+
+            // Another thread may have finished generating the thumbnail after it was looked up.
+            thumbnail = existingThumbnail(uri, requestedSize, crop, unbounded);
+            if ((!thumbnail.validPath() && !thumbnail.validImage()) || thumbnail.placeholder()) {
+                thumbnail = generateUncached(path, key, size, crop, mimeType);
+            }
+
+            inFlightGenerations->finish(generationId, thumbnail);
+            return thumbnail;
         } else {
             qCWarning(thumbnailer) << Q_FUNC_INFO << "Invalid thumbnail size " << requestedSize << " for " << path;
         }
@@ -407,30 +737,253 @@ NemoThumbnailCache::ThumbnailData NemoThumbnailCache::requestThumbnail(const QSt
     return ThumbnailData();
 }
 
+NemoThumbnailCache::ThumbnailData NemoThumbnailCache::requestStrip(const QString &uri, int frames,
+                                                                   const QSize &frameSize, const QString &mimeType)
+{
+    const QString path(imagePath(uri));
+    if (!validStrip(path, frames, frameSize)) {
+        qCWarning(thumbnailer) << Q_FUNC_INFO << "Invalid strip of" << frames << "frames of" << frameSize
+                               << "for" << path;
+        return ThumbnailData();
+    } else if (!mimeType.isEmpty() && !mimeType.startsWith(QLatin1String("video/"))) {
+        return ThumbnailData();
+    }
+
+    ThumbnailData strip(existingStrip(uri, frames, frameSize));
+    if (strip.validPath()) {
+        return strip;
+    }
+
+    const unsigned size = stripSize(frameSize);
+    const QByteArray key = stripKey(path, frames, size);
+    const QString generationId = cachePath(cachePath_, key);
+
+    if (inFlightGenerations->join(generationId, &strip)) {
+        return strip;
+    }
+
+    strip = existingStrip(uri, frames, frameSize);
+    if (!strip.validPath()) {
+        strip = generateVideoStrip(cachePath_, path, key, frames, size);
+    }
+
+    inFlightGenerations->finish(generationId, strip);
+    return strip;
+}
+
+NemoThumbnailCache::ThumbnailData NemoThumbnailCache::existingStrip(const QString &uri, int frames,
+                                                                    const QSize &frameSize) const
+{
+    const QString path(imagePath(uri));
+    if (validStrip(path, frames, frameSize)) {
+        const unsigned size = stripSize(frameSize);
+        const QString thumbnailPath = attemptCachedServe(cachePath_, path, stripKey(path, frames, size));
+        if (!thumbnailPath.isEmpty()) {
+            NemoThumbnailTrace::mark(NemoThumbnailTrace::Probed);
+            return ThumbnailData(thumbnailPath, QImage(), size);
+        }
+    }
+
+    NemoThumbnailTrace::mark(NemoThumbnailTrace::Probed);
+    return ThumbnailData();
+}
+
+QVector<NemoThumbnailCache::ThumbnailData> NemoThumbnailCache::existingThumbnails(
+        const QVector<Probe> &probes) const
+{
+    struct Candidate
+    {
+        int probe;
+        int entry;
+        int source;
+        unsigned size;
+        bool placeholder;
+    };
+
+    QVector<ThumbnailData> thumbnails(probes.count());
+    QVector<Candidate> candidates;
+    QVector<QByteArray> files;
+
+    NemoThumbnailWriter *writer = NemoThumbnailWriter::instance();
+
+    // Gather the entries which would be tried for each probe in order of preference, and the
+    // sources they need to be compared against.
+    for (int i = 0; i < probes.count(); ++i) {
+        const Probe &probe = probes.at(i);
+        const QString path(imagePath(probe.path));
+        if (path.isEmpty()) {
+            continue;
+        }
+
+        // Entries of sources in watched directories are removed when the source changes.
+        int source = -1;
+        if (!watchedDirectories->contains(cachePath_, path)) {
+            source = files.count();
+            files.append(QFile::encodeName(path));
+        }
+
+        QVector<QPair<unsigned, bool>> sizes;
+        if (probe.frames > 0) {
+            if (validStrip(path, probe.frames, probe.requestedSize)) {
+                sizes.append(qMakePair(stripSize(probe.requestedSize), false));
+            }
+        } else {
+            const int index = sizes_.indexOf(
+                        selectSize(probe.requestedSize, sizes_, probe.crop, probe.unbounded));
+            for (int j = index; j < sizes_.count(); ++j) {
+                sizes.append(qMakePair(sizes_.at(j), false));
+            }
+            for (int j = index - 1; j >= 0; --j) {
+                sizes.append(qMakePair(sizes_.at(j), true));
+            }
+        }
+
+        for (const QPair<unsigned, bool> &size : sizes) {
+            const QString thumbnailPath = cachePath(cachePath_, probe.frames > 0
+                    ? stripKey(path, probe.frames, size.first)
+                    : cacheKey(path, size.first, probe.crop));
+
+            // Recently generated thumbnails may not have been written to disk yet, nothing
+            // less preferable need be checked.
+            if (writer && probe.frames == 0) {
+                bool written = false;
+                const QImage image = writer->pendingImage(thumbnailPath, path, &written);
+                if (!image.isNull()) {
+                    candidates.append({ i, -1, source, size.first, size.second });
+                    thumbnails[i] = ThumbnailData(
+                                written ? thumbnailPath : QString(), image, size.first, size.second);
+                    break;
+                }
+            }
+
+            candidates.append({ i, files.count(), source, size.first, size.second });
+            files.append(QFile::encodeName(thumbnailPath));
+        }
+    }
+
+    const QVector<NemoBatchStat::Result> results = NemoBatchStat::stat(files);
+
+    QVector<bool> resolved(probes.count(), false);
+    for (const Candidate &candidate : candidates) {
+        if (resolved.at(candidate.probe)) {
+            continue;
+        } else if (candidate.entry < 0) {
+            // A pending image, resolved already.
+            resolved[candidate.probe] = true;
+            continue;
+        }
+
+        const NemoBatchStat::Result &entry = results.at(candidate.entry);
+        if (entry.exists
+                && (candidate.source < 0 || entry.modified >= results.at(candidate.source).modified)) {
+            resolved[candidate.probe] = true;
+            thumbnails[candidate.probe] = ThumbnailData(
+                        QFile::decodeName(files.at(candidate.entry)), QImage(), candidate.size,
+                        candidate.placeholder);
+        }
+    }
+
+    return thumbnails;
+}
+
+QRect NemoThumbnailCache::stripFrame(const QSize &stripSize, int frames, int frame)
+{
+    if (frames < 1 || frame < 0 || frame >= frames) {
+        return QRect();
+    }
+
+    const int columns = stripColumns(frames);
+    const int width = stripSize.width() / columns;
+    const int height = stripSize.height() / stripRows(frames);
+    return QRect(frame % columns * width, frame / columns * height, width, height);
+}
+
+NemoThumbnailCache::ThumbnailData NemoThumbnailCache::generateUncached(
+        const QString &path, const QByteArray &key, int size, bool crop, const QString &mimeType)
+{
+    QString thumbnailPath;
+    switch (NemoThumbnailDaemonClient::generate(path, key, size, crop, mimeType, &thumbnailPath)) {
+    case NemoThumbnailDaemonClient::Generated:
+        return ThumbnailData(thumbnailPath, QImage(), size);
+    case NemoThumbnailDaemonClient::Failed:
+        return ThumbnailData();
+    case NemoThumbnailDaemonClient::Unavailable:
+        break;
+    }
+
+    return generateThumbnail(path, key, size, crop, mimeType);
+}
+
 NemoThumbnailCache::ThumbnailData NemoThumbnailCache::existingThumbnail(const QString &uri, const QSize &requestedSize,
                                                                         bool crop, bool unbounded) const
 {
     const QString path(imagePath(uri));
     if (!path.isEmpty()) {
-        for (unsigned size = selectSize(requestedSize, screenWidth_, screenHeight_, crop, unbounded);
-                size != None;
-                size = nextSize(size, screenWidth_, screenHeight_, unbounded)) {
-            const QByteArray key = cacheKey(path, size, crop);
-            QString thumbnailPath = attemptCachedServe(cachePath_, path, key);
-            if (!thumbnailPath.isEmpty()) {
-                return ThumbnailData(thumbnailPath, QImage(), size);
+        const int index = sizes_.indexOf(selectSize(requestedSize, sizes_, crop, unbounded));
+
+        // Try the selected size, then larger entries which scale down to the same result, and
+        // finally smaller entries which can stand in until the thumbnail has been generated.
+        for (int i = index; i < sizes_.count(); ++i) {
+            const ThumbnailData thumbnail = existingEntry(cachePath_, path, sizes_.at(i), crop, false);
+            if (thumbnail.validPath() || thumbnail.validImage()) {
+                NemoThumbnailTrace::mark(NemoThumbnailTrace::Probed);
+                return thumbnail;
+            }
+        }
+        for (int i = index - 1; i >= 0; --i) {
+            const ThumbnailData thumbnail = existingEntry(cachePath_, path, sizes_.at(i), crop, true);
+            if (thumbnail.validPath() || thumbnail.validImage()) {
+                NemoThumbnailTrace::mark(NemoThumbnailTrace::Probed);
+                return thumbnail;
             }
         }
     }
 
+    NemoThumbnailTrace::mark(NemoThumbnailTrace::Probed);
     return ThumbnailData();
 }
 
+// Normalizes a generated thumbnail and writes it to the cache.  The image is returned straight
+// away and written in the background, if the writer can't keep up it is only held in memory and
+// no path is returned.
+static NemoThumbnailCache::ThumbnailData storeThumbnail(const QString &thumbnailsCachePath, const QString &path,
+                                                       const QByteArray &key, int requestedSize, QImage img,
+                                                       bool opaque)
+{
+    // Entries are stored without alpha when there are no translucent pixels, so this is
+    // decided once here and never when the entry is loaded again.
+    if (img.hasAlphaChannel() && (opaque || !NemoImageAlpha::hasAlphaPixels(img))) {
+        convertImageToFormat(&img, QImage::Format_RGBX8888);
+    }
+
+    optimizeImageForTexture(&img);
+
+    // Record the source as described by the freedesktop.org thumbnail specification so
+    // maintenance can find entries whose source has gone or changed.
+    img.setText(QStringLiteral("Thumb::URI"), QUrl::fromLocalFile(path).toString());
+    img.setText(QStringLiteral("Thumb::MTime"), QString::number(QFileInfo(path).lastModified().toSecsSinceEpoch()));
+
+    const QString thumbnailPath(cachePath(thumbnailsCachePath, key, true));
+    NemoThumbnailWriter *writer = NemoThumbnailWriter::instance();
+    const bool written = writer
+            ? writer->enqueue(thumbnailPath, img)
+            : NemoThumbnailWriter::write(thumbnailPath, img);
+    NemoThumbnailTrace::mark(NemoThumbnailTrace::Stored);
+
+    return NemoThumbnailCache::ThumbnailData(written ? thumbnailPath : QString(), img, requestedSize);
+}
+
 NemoThumbnailCache::ThumbnailData NemoThumbnailCache::generateThumbnail(
         const QString &path, const QByteArray &key, int size, bool crop, const QString &mimeType)
 {
     const QSize boundsSize(size, size);
 
+    // Generator plugins are preferred to the built in generators so they can replace them.
+    const QImage generated = NemoThumbnailGenerators::generate(path, mimeType, boundsSize, crop);
+    if (!generated.isNull()) {
+        return storeThumbnail(cachePath_, path, key, size, generated, false);
+    }
+
     if (mimeType == QStringLiteral("application/pdf")) {
         return generatePdfThumbnail(cachePath_, path, key, boundsSize, crop);
     }
@@ -449,30 +1002,37 @@ NemoThumbnailCache::ThumbnailData NemoThumbnailCache::generateImageThumbnail(con
                                                                              int requestedSize,
                                                                              bool crop)
 {
+    // Generating thumbnails of many originals shouldn't push everything else out of the page
+    // cache, the source is released again once it has been decoded.
+    const NemoSourceFile source(path);
+
     // image was not in cache thus we read it
     QImageReader ir(path);
     if (ir.canRead()) {
         const QSize originalSize = ir.size();
-
-        if ((ir.transformation() == QImageIOHandler::TransformationNone
-             || requestedSize > NemoThumbnailCache::ExtraLarge)
-                && (originalSize.width() * 9 < requestedSize * 10
-                    || originalSize.height() * 9 < requestedSize * 10)) {
-            return NemoThumbnailCache::ThumbnailData(path, QImage(), requestedSize);
+        const bool opaque = NemoImageAlpha::sourceIsOpaque(ir.device(), ir.format());
+
+        // A cropped thumbnail is scaled by the short side of the source and cut to the bounds of
+        // the thumbnail, a fitted thumbnail is scaled by the long side.
+        const int scaledSide = crop
+                ? qMin(originalSize.width(), originalSize.height())
+                : qMax(originalSize.width(), originalSize.height());
+
+        QImage img;
+        if (originalSize.isValid() && scaledSide * 9 < requestedSize * 10) {
+            // The source is barely larger than the thumbnail, don't scale it but still cache a
+            // normalized copy so displaying it again doesn't decode the original.
+            img = readUnscaledImage(&ir, QSize(requestedSize, requestedSize), crop);
+        } else {
+            img = readImageThumbnail(&ir, QSize(requestedSize, requestedSize), crop, Qt::FastTransformation);
         }
 
-        QImage img = readImageThumbnail(&ir, QSize(requestedSize, requestedSize), crop, Qt::FastTransformation);
-
-        if (img.data_ptr() && !img.data_ptr()->checkForAlphaPixels()) {
-            convertImageToFormat(&img, QImage::Format_RGB32);
+        if (img.isNull()) {
+            qCDebug(thumbnailer) << Q_FUNC_INFO << "Could not read image:" << path;
+            return NemoThumbnailCache::ThumbnailData();
         }
 
-        // write the scaled image to cache
-        QString thumbnailPath = writeCacheFile(key, img);
-
-        optimizeImageForTexture(&img);
-
-        return NemoThumbnailCache::ThumbnailData(thumbnailPath, img, requestedSize);
+        return storeThumbnail(cachePath_, path, key, requestedSize, img, opaque);
     }
 
     qCDebug(thumbnailer) << Q_FUNC_INFO << "Could not generateImageThumbnail:" << path << requestedSize << crop;
@@ -485,6 +1045,19 @@ QImage NemoThumbnailCache::readImageThumbnail(
         bool crop,
         Qt::TransformationMode mode)
 {
+#ifdef HAS_LIBJPEG
+    // Reading the format opens the device, the decoder reads the same file through its handle.
+    QFileDevice * const file = reader->format() == "jpeg"
+            ? qobject_cast<QFileDevice *>(reader->device())
+            : nullptr;
+    if (file && file->isOpen()) {
+        const QImage image = NemoJpegDecoder::read(file, requestedSize, crop, mode);
+        if (!image.isNull()) {
+            return image;
+        }
+    }
+#endif
+
     if (mode == Qt::FastTransformation) {
         // Quality in the jpeg reader is binary. >= 50: high quality, < 50 fast.
         reader->setQuality(49);
@@ -496,6 +1069,40 @@ QImage NemoThumbnailCache::readImageThumbnail(
 
     reader->setAutoTransform(true);
 
+    if (mode == Qt::FastTransformation) {
+        // Let decoders which can cheaply scale while decoding do so, but keep enough resolution
+        // for the area averaging scaler to filter the result.
+        QSize regionSize(originalSize);
+        if (crop && originalSize.isValid() && reader->supportsOption(QImageIOHandler::ClipRect)) {
+            // Only ask for the centre region which survives cropping so handlers which can
+            // skip rows and columns while decoding don't decode the rest.
+            const QSize scaledSize = originalSize.scaled(rotatedSize, Qt::KeepAspectRatioByExpanding);
+            regionSize = QSize(
+                        (qint64(originalSize.width()) * rotatedSize.width() + scaledSize.width() - 1)
+                            / scaledSize.width(),
+                        (qint64(originalSize.height()) * rotatedSize.height() + scaledSize.height() - 1)
+                            / scaledSize.height()).boundedTo(originalSize);
+
+            QRect clipRect(QPoint(0, 0), regionSize);
+            clipRect.moveCenter(QRect(QPoint(0, 0), originalSize).center());
+            reader->setClipRect(clipRect);
+        }
+
+        if (regionSize.isValid() && reader->supportsOption(QImageIOHandler::ScaledSize)) {
+            QSize decodeSize(regionSize);
+            decodeSize.scale(rotatedSize * 2, crop ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio);
+            if (decodeSize.width() < regionSize.width() && decodeSize.height() < regionSize.height()) {
+                reader->setScaledSize(decodeSize);
+            }
+        }
+
+        QImage image = reader->read();
+        NemoThumbnailTrace::mark(NemoThumbnailTrace::Decoded);
+        image = NemoImageScaler::scaleImage(image, requestedSize, crop, mode);
+        NemoThumbnailTrace::mark(NemoThumbnailTrace::Scaled);
+        return image;
+    }
+
     if (originalSize.isValid()) {
         if (crop) {
             // scales arbitrary sized source image to requested size scaling either up or down
@@ -524,10 +1131,12 @@ QImage NemoThumbnailCache::readImageThumbnail(
     }
 
     QImage image(reader->read());
+    NemoThumbnailTrace::mark(NemoThumbnailTrace::Decoded);
 
     if (!originalSize.isValid()) {
-        image = scaleImage(image, rotatedSize, crop, mode);
+        image = NemoImageScaler::scaleImage(image, rotatedSize, crop, mode);
     }
+    NemoThumbnailTrace::mark(NemoThumbnailTrace::Scaled);
 
     return image;
 }
@@ -535,13 +1144,17 @@ QImage NemoThumbnailCache::readImageThumbnail(
 QString NemoThumbnailCache::writeCacheFile(const QByteArray &key, const QImage &img)
 {
     const QString thumbnailPath(cachePath(cachePath_, key, true));
-    QFile thumbnailFile(thumbnailPath);
-    if (!thumbnailFile.open(QIODevice::WriteOnly)) {
-        qCWarning(thumbnailer) << "Couldn't cache to " << thumbnailFile.fileName();
+    if (!NemoThumbnailWriter::write(thumbnailPath, img)) {
+        qCWarning(thumbnailer) << "Couldn't write thumbnail to " << thumbnailPath;
         return QString();
     }
-    img.save(&thumbnailFile, img.hasAlphaChannel() ? "PNG" : "JPG");
-    thumbnailFile.flush();
-    thumbnailFile.close();
     return thumbnailPath;
 }
+
+bool NemoThumbnailCache::waitForCacheFile(const QString &thumbnailPath)
+{
+    if (NemoThumbnailWriter *writer = NemoThumbnailWriter::instance()) {
+        writer->waitForWritten(thumbnailPath);
+    }
+    return QFileInfo::exists(thumbnailPath);
+}
@@ -35,8 +35,10 @@
 #include <nemothumbnailexports.h>
 
 #include <QImage>
+#include <QRect>
 #include <QSize>
 #include <QString>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
 class QImageReader;
@@ -57,7 +59,7 @@ public:
     {
     public:
         ThumbnailData();
-        ThumbnailData(const QString &path, const QImage &image, unsigned size);
+        ThumbnailData(const QString &path, const QImage &image, unsigned size, bool placeholder = false);
 
         bool validPath() const;
         QString path() const;
@@ -67,23 +69,63 @@ public:
 
         unsigned size() const;
 
+        // True if the thumbnail is a smaller size than requested which can be shown until the
+        // requested size has been generated.
+        bool placeholder() const;
+
         QImage getScaledImage(const QSize &requestedSize, bool crop = false,
                               Qt::TransformationMode mode = Qt::FastTransformation) const;
 
+        // Returns the thumbnail at the size it was stored, as needed for strips.
+        QImage getImage() const;
+
     private:
         QString path_;
         QImage image_;
         unsigned size_;
+        bool placeholder_;
+    };
+
+    enum ClientPriority {
+        HighPriority,
+        NormalPriority,
+        LowPriority
     };
 
     static NemoThumbnailCache *instance();
 
+    static void setClientPriority(ClientPriority priority);
+
     ThumbnailData requestThumbnail(const QString &path, const QSize &requestedSize, bool crop,
                                    bool unbounded = true, const QString &mimeType = QString());
 
     ThumbnailData existingThumbnail(const QString &path, const QSize &requestedSize,
                                     bool crop, bool unbounded = true) const;
 
+    // A lookup made by existingThumbnail(), or by existingStrip() if frames is not 0.
+    struct Probe
+    {
+        QString path;
+        QSize requestedSize;
+        bool crop = true;
+        bool unbounded = true;
+        int frames = 0;
+    };
+
+    // Returns the same results as making each lookup separately, but checks the cache entries
+    // of all of them together so a batch costs about one round trip to the storage device.
+    QVector<ThumbnailData> existingThumbnails(const QVector<Probe> &probes) const;
+
+    // A strip is a number of frames evenly spaced through a video, each scaled to fit within
+    // frameSize and packed in rows into a single image, so a scrubbing preview needs only one
+    // decode and one texture.
+    ThumbnailData requestStrip(const QString &path, int frames, const QSize &frameSize,
+                               const QString &mimeType = QString());
+    ThumbnailData existingStrip(const QString &path, int frames, const QSize &frameSize) const;
+
+    // Returns the area of a strip image occupied by frame.
+    static QRect stripFrame(const QSize &stripSize, int frames, int frame);
+
 protected:
     NemoThumbnailCache(const QString &cachePath);
     virtual ~NemoThumbnailCache();
@@ -91,17 +133,19 @@ protected:
     virtual ThumbnailData generateThumbnail(const QString &path, const QByteArray &key,
                                             int size, bool crop, const QString &mimeType);
     QString writeCacheFile(const QByteArray &key, const QImage &image);
+    static bool waitForCacheFile(const QString &thumbnailPath);
 
     static QImage readImageThumbnail(
             QImageReader *reader, QSize requestedSize, bool crop, Qt::TransformationMode mode);
 
 private:
+    ThumbnailData generateUncached(const QString &path, const QByteArray &key, int size, bool crop,
+                                   const QString &mimeType);
     inline NemoThumbnailCache::ThumbnailData generateImageThumbnail(
             const QString &path, const QByteArray &key, int requestedSize, bool crop);
 
     const QString cachePath_;
-    unsigned screenWidth_;
-    unsigned screenHeight_;
+    QVector<unsigned> sizes_;
 };
 
 #endif // NEMOTHUMBNAILCACHE_H
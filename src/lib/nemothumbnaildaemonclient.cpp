@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemothumbnaildaemonclient_p.h"
+#include "nemothumbnailprotocol_p.h"
+
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QLocalSocket>
+#include <QLoggingCategory>
+#include <QThreadStorage>
+
+Q_DECLARE_LOGGING_CATEGORY(thumbnailer)
+
+namespace {
+
+// How long to wait before trying to connect again after the daemon could not be reached.
+const qint64 ReconnectInterval = 5000;
+const int ConnectTimeout = 100;
+// How long to wait for the daemon to generate a thumbnail before generating it in-process, the
+// daemon may be busy with the requests of other clients.
+const int GenerateTimeout = 5000;
+
+int initialPriority()
+{
+    const QByteArray priority = qgetenv("NEMO_THUMBNAILER_PRIORITY");
+    if (priority == "high") {
+        return NemoThumbnailCache::HighPriority;
+    } else if (priority == "low") {
+        return NemoThumbnailCache::LowPriority;
+    } else {
+        return NemoThumbnailCache::NormalPriority;
+    }
+}
+
+bool daemonEnabled()
+{
+    static const bool enabled = qgetenv("NEMO_THUMBNAILER_DAEMON") != "0";
+    return enabled;
+}
+
+QAtomicInt clientPriority(initialPriority());
+
+struct Connection
+{
+    QLocalSocket socket;
+    QByteArray buffer;
+    quint32 nextId = 0;
+    int sentPriority = -1;
+    qint64 reconnectTime = 0;
+
+    bool ensureConnected()
+    {
+        if (socket.state() == QLocalSocket::ConnectedState) {
+            return true;
+        }
+
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        if (now < reconnectTime) {
+            return false;
+        }
+
+        socket.abort();
+        buffer.clear();
+        sentPriority = -1;
+
+        socket.connectToServer(NemoThumbnailProtocol::socketPath());
+        if (!socket.waitForConnected(ConnectTimeout)) {
+            socket.abort();
+            reconnectTime = now + ReconnectInterval;
+            return false;
+        }
+
+        qCDebug(thumbnailer) << "Connected to thumbnail daemon";
+        return true;
+    }
+
+    void sendHello()
+    {
+        const int priority = clientPriority.loadAcquire();
+        if (priority == sentPriority) {
+            return;
+        }
+
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(NemoThumbnailProtocol::streamVersion());
+        stream << quint8(NemoThumbnailProtocol::Hello)
+               << quint32(NemoThumbnailProtocol::Version)
+               << qint32(priority);
+
+        NemoThumbnailProtocol::writeMessage(&socket, payload);
+        sentPriority = priority;
+    }
+};
+
+QThreadStorage<Connection *> connections;
+
+}
+
+NemoThumbnailDaemonClient::Result NemoThumbnailDaemonClient::generate(
+        const QString &path, const QByteArray &key, int size, bool crop, const QString &mimeType,
+        QString *thumbnailPath)
+{
+    if (!daemonEnabled()) {
+        return Unavailable;
+    }
+
+    if (!connections.hasLocalData()) {
+        connections.setLocalData(new Connection);
+    }
+    Connection *connection = connections.localData();
+
+    if (!connection->ensureConnected()) {
+        return Unavailable;
+    }
+
+    connection->sendHello();
+
+    const quint32 id = ++connection->nextId;
+
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(NemoThumbnailProtocol::streamVersion());
+    stream << quint8(NemoThumbnailProtocol::Request) << id << path << key << qint32(size) << crop << mimeType;
+
+    NemoThumbnailProtocol::writeMessage(&connection->socket, payload);
+    connection->socket.flush();
+
+    // If the daemon went away while processing a request never fall back to generating
+    // in-process, the source is likely to crash this process too.  A daemon which is slow to
+    // reply is bypassed for a while instead so the caller isn't starved.
+    QDeadlineTimer deadline(GenerateTimeout);
+    for (;;) {
+        QByteArray message;
+        switch (NemoThumbnailProtocol::takeMessage(&connection->buffer, &message)) {
+        case NemoThumbnailProtocol::Invalid:
+            qCWarning(thumbnailer) << "Invalid message from thumbnail daemon";
+            connection->socket.abort();
+            return Failed;
+        case NemoThumbnailProtocol::Taken: {
+            QDataStream reply(message);
+            reply.setVersion(NemoThumbnailProtocol::streamVersion());
+
+            quint8 type = 0;
+            quint32 replyId = 0;
+            QByteArray replyKey;
+            bool ok = false;
+            QString replyPath;
+            reply >> type >> replyId >> replyKey >> ok >> replyPath;
+
+            if (type == NemoThumbnailProtocol::Completed && replyId == id) {
+                if (ok && !replyPath.isEmpty()) {
+                    *thumbnailPath = replyPath;
+                    return Generated;
+                }
+                return Failed;
+            }
+            continue;
+        }
+        case NemoThumbnailProtocol::Incomplete:
+            break;
+        }
+
+        if (connection->socket.bytesAvailable() > 0) {
+            connection->buffer.append(connection->socket.readAll());
+            continue;
+        }
+
+        if (connection->socket.state() == QLocalSocket::ConnectedState
+                && !deadline.hasExpired()
+                && connection->socket.waitForReadyRead(deadline.remainingTime())) {
+            connection->buffer.append(connection->socket.readAll());
+            continue;
+        }
+
+        const bool stalled = connection->socket.state() == QLocalSocket::ConnectedState;
+        connection->socket.abort();
+        if (stalled) {
+            qCWarning(thumbnailer) << "Thumbnail daemon is not responding, generating in-process" << path;
+            connection->reconnectTime = QDateTime::currentMSecsSinceEpoch() + ReconnectInterval;
+            return Unavailable;
+        }
+
+        qCWarning(thumbnailer) << "Thumbnail daemon did not complete" << path << size << crop;
+        return Failed;
+    }
+}
+
+void NemoThumbnailDaemonClient::setPriority(int priority)
+{
+    clientPriority.storeRelease(priority);
+}
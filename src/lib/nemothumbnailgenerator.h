@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#ifndef NEMOTHUMBNAILGENERATOR_H
+#define NEMOTHUMBNAILGENERATOR_H
+
+#include <nemothumbnailexports.h>
+
+#include <QImage>
+#include <QObject>
+#include <QSize>
+#include <QString>
+
+// Interface of in-process thumbnail generator plugins.
+//
+// Plugins are installed in the thumbnailers directory of the Nemo.Thumbnailer import and
+// describe what they generate in the metadata of Q_PLUGIN_METADATA, so they are only loaded
+// once a thumbnail is requested for one of their mime types:
+//
+//     {
+//         "MimeTypes": [ "application/epub+zip", "audio/*" ],
+//         "Cost": "cheap",
+//         "Output": "embedded"
+//     }
+//
+// Cost is one of "cheap", "moderate" or "expensive" and defaults to moderate.  Output is
+// "scaled" if the plugin renders to the requested size, or "embedded" if it returns a preview
+// embedded in the file at whatever size it was stored, which is then scaled.  Where several
+// plugins handle a mime type an exact match is preferred over a wildcard, then a lower cost,
+// then embedded previews.
+
+class NEMO_QML_PLUGIN_THUMBNAILER_EXPORT NemoThumbnailGenerator
+{
+public:
+    virtual ~NemoThumbnailGenerator();
+
+    // Returns a thumbnail of the file at path, or a null image if none could be generated in
+    // which case the next best generator is tried.  Scaled output should fit requestedSize, or
+    // fill it if crop is true.  This is called from multiple threads at once.
+    virtual QImage generate(const QString &path, const QString &mimeType, const QSize &requestedSize,
+                            bool crop) = 0;
+};
+
+#define NemoThumbnailGenerator_iid "org.nemomobile.thumbnailer.NemoThumbnailGenerator/1.0"
+
+Q_DECLARE_INTERFACE(NemoThumbnailGenerator, NemoThumbnailGenerator_iid)
+
+#endif // NEMOTHUMBNAILGENERATOR_H
@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include "nemothumbnailgenerators_p.h"
+
+#include "nemothumbnailgenerator.h"
+#include "nemoimagescaler_p.h"
+#include "nemothumbnailtrace_p.h"
+
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QPluginLoader>
+#include <QVector>
+
+#include <algorithm>
+
+Q_DECLARE_LOGGING_CATEGORY(thumbnailer)
+
+NemoThumbnailGenerator::~NemoThumbnailGenerator()
+{
+}
+
+namespace {
+
+enum Cost {
+    Cheap,
+    Moderate,
+    Expensive
+};
+
+struct Generator
+{
+    QString fileName;
+    QStringList mimeTypes;
+    Cost cost = Moderate;
+    bool embedded = false;
+
+    QPluginLoader *loader = nullptr;
+    NemoThumbnailGenerator *instance = nullptr;
+    bool failed = false;
+};
+
+class Generators
+{
+public:
+    Generators()
+    {
+        // Only the metadata is read here, the libraries are loaded when first used.
+        const QDir directory(QStringLiteral(NEMO_THUMBNAILER_DIR));
+        const QStringList fileNames = directory.entryList(QDir::Files);
+        for (const QString &fileName : fileNames) {
+            const QString filePath = directory.absoluteFilePath(fileName);
+            QPluginLoader loader(filePath);
+            const QJsonObject metaData = loader.metaData();
+            if (metaData.value(QStringLiteral("IID")).toString() != QLatin1String(NemoThumbnailGenerator_iid)) {
+                continue;
+            }
+
+            const QJsonObject description = metaData.value(QStringLiteral("MetaData")).toObject();
+
+            Generator generator;
+            generator.fileName = filePath;
+            for (const QJsonValue &mimeType : description.value(QStringLiteral("MimeTypes")).toArray()) {
+                generator.mimeTypes.append(mimeType.toString());
+            }
+
+            const QString cost = description.value(QStringLiteral("Cost")).toString();
+            if (cost == QLatin1String("cheap")) {
+                generator.cost = Cheap;
+            } else if (cost == QLatin1String("expensive")) {
+                generator.cost = Expensive;
+            }
+            generator.embedded = description.value(QStringLiteral("Output")).toString()
+                    == QLatin1String("embedded");
+
+            if (generator.mimeTypes.isEmpty()) {
+                qCWarning(thumbnailer) << "Thumbnail generator declares no mime types:" << filePath;
+            } else {
+                m_generators.append(generator);
+            }
+        }
+    }
+
+    ~Generators()
+    {
+        for (Generator &generator : m_generators) {
+            delete generator.loader;
+        }
+    }
+
+    // Returns the generators handling mimeType in order of preference.
+    QVector<Generator *> candidates(const QString &mimeType)
+    {
+        struct Candidate
+        {
+            Generator *generator;
+            bool exact;
+        };
+
+        const QString wildcard = mimeType.left(mimeType.indexOf(QLatin1Char('/')) + 1) + QLatin1Char('*');
+
+        QVector<Candidate> matches;
+        for (Generator &generator : m_generators) {
+            if (generator.mimeTypes.contains(mimeType)) {
+                matches.append({ &generator, true });
+            } else if (generator.mimeTypes.contains(wildcard)) {
+                matches.append({ &generator, false });
+            }
+        }
+
+        std::stable_sort(matches.begin(), matches.end(), [](const Candidate &left, const Candidate &right) {
+            if (left.exact != right.exact) {
+                return left.exact;
+            } else if (left.generator->cost != right.generator->cost) {
+                return left.generator->cost < right.generator->cost;
+            } else {
+                return left.generator->embedded && !right.generator->embedded;
+            }
+        });
+
+        QVector<Generator *> generators;
+        for (const Candidate &match : matches) {
+            generators.append(match.generator);
+        }
+        return generators;
+    }
+
+    NemoThumbnailGenerator *load(Generator *generator)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (!generator->instance && !generator->failed) {
+            generator->loader = new QPluginLoader(generator->fileName);
+            generator->instance = qobject_cast<NemoThumbnailGenerator *>(generator->loader->instance());
+            if (!generator->instance) {
+                qCWarning(thumbnailer) << "Could not load thumbnail generator:" << generator->loader->errorString();
+                generator->failed = true;
+            }
+        }
+        return generator->instance;
+    }
+
+    bool isEmpty() const
+    {
+        return m_generators.isEmpty();
+    }
+
+private:
+    QMutex m_mutex;
+    QVector<Generator> m_generators;
+};
+
+Q_GLOBAL_STATIC(Generators, generators)
+
+}
+
+QImage NemoThumbnailGenerators::generate(
+        const QString &path, const QString &mimeType, const QSize &requestedSize, bool crop)
+{
+    if (mimeType.isEmpty() || generators->isEmpty()) {
+        return QImage();
+    }
+
+    for (Generator *generator : generators->candidates(mimeType)) {
+        NemoThumbnailGenerator *instance = generators->load(generator);
+        if (!instance) {
+            continue;
+        }
+
+        QImage image = instance->generate(path, mimeType, requestedSize, crop);
+        NemoThumbnailTrace::mark(NemoThumbnailTrace::Decoded);
+        if (!image.isNull()) {
+            // Embedded previews are whatever size they were stored at, scaled output is only
+            // scaled again if it doesn't fit.
+            if (generator->embedded
+                    || image.width() > requestedSize.width()
+                    || image.height() > requestedSize.height()) {
+                image = NemoImageScaler::scaleImage(image, requestedSize, crop, Qt::FastTransformation);
+            }
+            NemoThumbnailTrace::mark(NemoThumbnailTrace::Scaled);
+            return image;
+        }
+
+        qCDebug(thumbnailer) << "Thumbnail generator" << generator->fileName << "failed for" << path;
+    }
+
+    return QImage();
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef NEMOTHUMBNAILPROTOCOL_P_H
+#define NEMOTHUMBNAILPROTOCOL_P_H
+
+#include "nemothumbnailcache.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QIODevice>
+#include <QStandardPaths>
+#include <QString>
+#include <QtEndian>
+
+#include <atomic>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Wire protocol shared by the thumbnail daemon and the in-library client.
+//
+// Every message is a quint32 payload length followed by a QDataStream encoded payload which
+// starts with a quint8 message type.
+
+namespace NemoThumbnailProtocol {
+
+enum {
+    Version = 1,
+    MaximumMessageSize = 64 * 1024
+};
+
+enum MessageType {
+    Hello = 1,      // client -> daemon: quint32 version, qint32 priority
+    Request,        // client -> daemon: quint32 id, QString path, QByteArray key, qint32 size,
+                    //                   bool crop, QString mimeType
+    Completed       // daemon -> client: quint32 id, QByteArray key, bool ok, QString thumbnailPath
+};
+
+// The priorities sent in Hello are the values of NemoThumbnailCache::ClientPriority.
+enum {
+    PriorityCount = NemoThumbnailCache::LowPriority + 1
+};
+
+inline QString cachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QLatin1String("/org.nemomobile/thumbnails");
+}
+
+// Hex encoded hash of a source path, the keys of all cache entries of the source start with it.
+inline QByteArray sourceHash(const QString &path)
+{
+    return QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha1).toHex();
+}
+
+// Written by the daemon while it watches directories for changes to their files.  Contains the
+// boot id and daemon pid on the first two lines followed by one watched directory per line.
+inline QString watchStatePath(const QString &cachePath)
+{
+    return cachePath + QLatin1String("/.watched");
+}
+
+// Written by the daemon whenever it saves the state of its watched directories and when it
+// exits.  Contains one source file in the watched directories per line.
+inline QString watchedSourcesPath(const QString &cachePath)
+{
+    return cachePath + QLatin1String("/.watched-sources");
+}
+
+inline QByteArray bootId()
+{
+    QFile file(QStringLiteral("/proc/sys/kernel/random/boot_id"));
+    return file.open(QIODevice::ReadOnly) ? file.readAll().trimmed() : QByteArray();
+}
+
+inline QString socketPath()
+{
+    const QByteArray override = qgetenv("NEMO_THUMBNAILER_SOCKET");
+    if (!override.isEmpty()) {
+        return QFile::decodeName(override);
+    }
+
+    QString runtimePath = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (runtimePath.isEmpty()) {
+        runtimePath = QStringLiteral("/tmp");
+    }
+    return runtimePath + QLatin1String("/nemo-thumbnailer");
+}
+
+inline qint64 monotonicTime()
+{
+    timespec time;
+    ::clock_gettime(CLOCK_MONOTONIC, &time);
+    return qint64(time.tv_sec) * 1000 + time.tv_nsec / 1000000;
+}
+
+// Shared memory holding the monotonicTime() at which the interactive loader last loaded
+// thumbnails, background generation backs off while it is recent.  Only the loader creates it,
+// null is returned to readers until it has.
+inline std::atomic<qint64> *mapBusyState(bool create)
+{
+    const QByteArray name = "/nemo-thumbnailer-busy-" + QByteArray::number(::getuid());
+    const int fd = ::shm_open(name.constData(), (create ? O_RDWR | O_CREAT : O_RDONLY) | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    const size_t size = sizeof(std::atomic<qint64>);
+    struct stat status;
+    void *address = MAP_FAILED;
+    if (create ? ::ftruncate(fd, size) == 0 : ::fstat(fd, &status) == 0 && size_t(status.st_size) >= size) {
+        address = ::mmap(nullptr, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    return address != MAP_FAILED ? static_cast<std::atomic<qint64> *>(address) : nullptr;
+}
+
+inline QDataStream::Version streamVersion()
+{
+    return QDataStream::Qt_5_6;
+}
+
+inline void writeMessage(QIODevice *device, const QByteArray &payload)
+{
+    QByteArray message;
+    message.reserve(payload.size() + 4);
+
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream.setVersion(streamVersion());
+    stream << quint32(payload.size());
+    message.append(payload);
+
+    device->write(message);
+}
+
+enum TakeResult {
+    Incomplete,
+    Taken,
+    Invalid
+};
+
+// Extracts one complete message payload from the front of buffer.
+inline TakeResult takeMessage(QByteArray *buffer, QByteArray *payload)
+{
+    if (buffer->size() < 4) {
+        return Incomplete;
+    }
+
+    const quint32 length = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(buffer->constData()));
+    if (length > MaximumMessageSize) {
+        return Invalid;
+    } else if (quint32(buffer->size() - 4) < length) {
+        return Incomplete;
+    }
+
+    *payload = buffer->mid(4, length);
+    buffer->remove(0, length + 4);
+    return Taken;
+}
+
+}
+
+#endif // NEMOTHUMBNAILPROTOCOL_P_H
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemothumbnailtrace_p.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QMutex>
+
+#include <time.h>
+
+Q_DECLARE_LOGGING_CATEGORY(thumbnailer)
+
+namespace {
+
+const char * const stageNames[] = {
+    "queued", "started", "probed", "decoded", "scaled", "stored", "delivered", "uploaded"
+};
+
+thread_local qint64 *currentTimestamps = nullptr;
+
+class TraceFile
+{
+public:
+    TraceFile()
+        : m_file(QFile::decodeName(qgetenv("NEMO_THUMBNAILER_TRACE")))
+    {
+        // The JSON array format doesn't need the closing bracket, so an interrupted process
+        // still leaves a valid trace.
+        if (m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            m_file.write("[\n");
+        } else {
+            qCWarning(thumbnailer) << "Cannot write trace to" << m_file.fileName() << m_file.errorString();
+        }
+    }
+
+    void write(const QByteArray &events)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_file.isOpen()) {
+            m_file.write(events);
+            m_file.flush();
+        }
+    }
+
+private:
+    QMutex m_mutex;
+    QFile m_file;
+};
+
+Q_GLOBAL_STATIC(TraceFile, traceFile)
+
+bool traceFileEnabled()
+{
+    static const bool enabled = !qgetenv("NEMO_THUMBNAILER_TRACE").isEmpty();
+    return enabled;
+}
+
+QByteArray traceEvent(const char *name, char phase, int id, qint64 timestamp, const QByteArray &args)
+{
+    return "{\"name\":\"" + QByteArray(name)
+            + "\",\"cat\":\"thumbnail\",\"ph\":\"" + phase
+            + "\",\"id\":" + QByteArray::number(id)
+            + ",\"pid\":" + QByteArray::number(QCoreApplication::applicationPid())
+            + ",\"tid\":0,\"ts\":" + QByteArray::number(timestamp / 1000.0, 'f', 3)
+            + args + "},\n";
+}
+
+QByteArray jsonString(const QString &string)
+{
+    QByteArray escaped;
+    for (const char c : string.toUtf8()) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (uchar(c) < 0x20) {
+            escaped += "\\u00" + QByteArray::number(uchar(c), 16).rightJustified(2, '0');
+        } else {
+            escaped += c;
+        }
+    }
+    return '"' + escaped + '"';
+}
+
+}
+
+NemoThumbnailTrace::Scope::Scope(qint64 *timestamps)
+    : m_previous(currentTimestamps)
+{
+    currentTimestamps = timestamps;
+}
+
+NemoThumbnailTrace::Scope::~Scope()
+{
+    currentTimestamps = m_previous;
+}
+
+const char *NemoThumbnailTrace::stageName(Stage stage)
+{
+    return stageNames[stage];
+}
+
+bool NemoThumbnailTrace::isEnabled()
+{
+    static const bool enabled = thumbnailer().isDebugEnabled() || traceFileEnabled();
+    return enabled;
+}
+
+qint64 NemoThumbnailTrace::timestamp()
+{
+    struct timespec time;
+    ::clock_gettime(CLOCK_MONOTONIC, &time);
+    return qint64(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+void NemoThumbnailTrace::mark(Stage stage)
+{
+    if (qint64 * const timestamps = currentTimestamps) {
+        timestamps[stage] = timestamp();
+    }
+}
+
+void NemoThumbnailTrace::finish(const QString &path, const QSize &size, const qint64 *timestamps)
+{
+    if (thumbnailer().isDebugEnabled()) {
+        QDebug debug = qDebug(thumbnailer).nospace();
+        debug << "Thumbnail " << path << " " << size.width() << "x" << size.height() << ":";
+
+        qint64 previous = timestamps[Queued];
+        for (int stage = Started; stage < StageCount; ++stage) {
+            if (timestamps[stage] != 0) {
+                debug << " " << stageNames[stage] << " +" << (timestamps[stage] - previous) / 1000000.0 << "ms";
+                previous = timestamps[stage];
+            }
+        }
+        debug << " total " << (previous - timestamps[Queued]) / 1000000.0 << "ms";
+    }
+
+    if (traceFileEnabled()) {
+        static QAtomicInt nextId;
+        const int id = nextId.fetchAndAddRelaxed(1);
+
+        const QByteArray args = ",\"args\":{\"path\":" + jsonString(path)
+                + ",\"size\":\"" + QByteArray::number(size.width()) + "x" + QByteArray::number(size.height())
+                + "\"}";
+
+        // A slice for the whole request with a nested slice for each stage it went through.
+        QByteArray events;
+        qint64 previous = timestamps[Queued];
+        for (int stage = Started; stage < StageCount; ++stage) {
+            if (timestamps[stage] != 0) {
+                events += traceEvent(stageNames[stage], 'b', id, previous, QByteArray());
+                events += traceEvent(stageNames[stage], 'e', id, timestamps[stage], QByteArray());
+                previous = timestamps[stage];
+            }
+        }
+        events.prepend(traceEvent("request", 'b', id, timestamps[Queued], args));
+        events += traceEvent("request", 'e', id, previous, QByteArray());
+
+        traceFile->write(events);
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef NEMOTHUMBNAILTRACE_P_H
+#define NEMOTHUMBNAILTRACE_P_H
+
+#include <nemothumbnailexports.h>
+
+#include <QSize>
+#include <QString>
+
+// Records when a thumbnail request passes through each stage of loading.
+//
+// Tracing is enabled if debug output is enabled for the Nemo.Thumbnailer logging category or
+// NEMO_THUMBNAILER_TRACE names a file to write a Chrome JSON trace to, which can be opened with
+// chrome://tracing or Perfetto.  The library records the stages it performs on the thread with
+// an active Scope, completed requests are reported with finish().
+class NEMO_QML_PLUGIN_THUMBNAILER_EXPORT NemoThumbnailTrace
+{
+public:
+    enum Stage {
+        Queued,     // The request was created.
+        Started,    // A loader thread started on the request.
+        Probed,     // The cache was searched for an existing entry.
+        Decoded,    // The source or cache entry was decoded.
+        Scaled,     // The image was scaled to its final size.
+        Stored,     // A generated thumbnail was handed to the cache writer.
+        Delivered,  // The image was delivered to the GUI thread.
+        Uploaded,   // The image was uploaded to a texture.
+        StageCount
+    };
+
+    class NEMO_QML_PLUGIN_THUMBNAILER_EXPORT Scope
+    {
+    public:
+        explicit Scope(qint64 *timestamps);
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        qint64 * const m_previous;
+    };
+
+    static bool isEnabled();
+
+    static const char *stageName(Stage stage);
+
+    // Monotonic time in nanoseconds.
+    static qint64 timestamp();
+
+    static void mark(Stage stage);
+    static void finish(const QString &path, const QSize &size, const qint64 *timestamps);
+};
+
+#endif // NEMOTHUMBNAILTRACE_P_H
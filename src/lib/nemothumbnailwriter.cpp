@@ -0,0 +1,323 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemothumbnailwriter_p.h"
+#include "nemoqoicodec_p.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QVector>
+
+#include <cstdio>
+#include <unistd.h>
+
+Q_DECLARE_LOGGING_CATEGORY(thumbnailer)
+
+namespace {
+
+// Beyond this much unwritten data the writer is considered to have fallen behind.
+const qint64 MaximumQueuedBytes = 32 * 1024 * 1024;
+const qint64 MaximumMemoryBytes = 16 * 1024 * 1024;
+// How long to stop writing to disk after a write failed.
+const qint64 MemoryOnlyInterval = 60 * 1000;
+const int MaximumBatchSize = 16;
+
+QAtomicInt temporaryCounter;
+
+bool storeOpaqueAsQoi()
+{
+    static const bool qoi = qgetenv("NEMO_THUMBNAILER_OPAQUE_FORMAT") == "qoi";
+    return qoi;
+}
+
+qint64 imageBytes(const QImage &image)
+{
+    return qint64(image.bytesPerLine()) * image.height();
+}
+
+QString temporaryPath(const QString &path)
+{
+    return path + QLatin1String(".tmp-")
+            + QString::number(QCoreApplication::applicationPid())
+            + QLatin1Char('-')
+            + QString::number(temporaryCounter.fetchAndAddRelaxed(1));
+}
+
+bool publish(const QString &temporaryPath, const QString &path)
+{
+    // Unlike QFile::rename() this replaces an existing entry atomically.
+    if (::rename(QFile::encodeName(temporaryPath).constData(), QFile::encodeName(path).constData()) != 0) {
+        QFile::remove(temporaryPath);
+        return false;
+    }
+    return true;
+}
+
+Q_GLOBAL_STATIC(NemoThumbnailWriter, writerInstance)
+
+}
+
+NemoThumbnailWriter::NemoThumbnailWriter()
+    : m_queuedBytes(0)
+    , m_memoryBytes(0)
+    , m_memoryOnlyUntil(0)
+    , m_quit(false)
+{
+}
+
+NemoThumbnailWriter::~NemoThumbnailWriter()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_quit = true;
+        m_waitCondition.wakeOne();
+    }
+
+    // Anything still queued is written before the thread exits.
+    wait();
+}
+
+NemoThumbnailWriter *NemoThumbnailWriter::instance()
+{
+    return writerInstance();
+}
+
+bool NemoThumbnailWriter::encode(QIODevice *device, const QImage &image)
+{
+    // QOI encodes and decodes many times faster than PNG, opaque images stay JPEG by default as
+    // QOI is several times larger for photographic content.
+    return image.hasAlphaChannel() || storeOpaqueAsQoi()
+            ? NemoQoiCodec::write(device, image)
+            : image.save(device, "JPG");
+}
+
+bool NemoThumbnailWriter::write(const QString &path, const QImage &image)
+{
+    const QString temporary = temporaryPath(path);
+
+    QFile file(temporary);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    const bool encoded = encode(&file, image);
+    file.close();
+
+    if (!encoded || file.error() != QFileDevice::NoError) {
+        file.remove();
+        return false;
+    }
+
+    return publish(temporary, path);
+}
+
+bool NemoThumbnailWriter::enqueue(const QString &path, const QImage &image)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 bytes = imageBytes(image);
+
+    if (m_queuedImages.contains(path)) {
+        // The source changed and was generated again before the earlier thumbnail was written,
+        // replace it.  If it is being written now write the new one after it.
+        m_queuedImages.insert(path, image);
+        m_queuedBytes += bytes;
+
+        QList<Entry>::iterator it = m_queue.begin();
+        for (; it != m_queue.end() && it->path != path; ++it) {
+        }
+        if (it != m_queue.end()) {
+            m_queuedBytes -= imageBytes(it->image);
+            it->image = image;
+            it->created = now;
+            return true;
+        }
+    } else if (m_queuedBytes + bytes > MaximumQueuedBytes || now < m_memoryOnlyUntil) {
+        storeInMemory(path, image, now);
+        return false;
+    } else {
+        m_queuedImages.insert(path, image);
+        m_queuedBytes += bytes;
+    }
+
+    // An older thumbnail held in memory would be returned in place of the entry once written.
+    if (m_memoryImages.contains(path)) {
+        m_memoryBytes -= imageBytes(m_memoryImages.take(path).image);
+        m_memoryOrder.removeOne(path);
+    }
+
+    m_queue.append({ path, image, now });
+
+    if (!isRunning()) {
+        start(QThread::LowestPriority);
+    }
+    m_waitCondition.wakeOne();
+
+    return true;
+}
+
+QImage NemoThumbnailWriter::pendingImage(const QString &path, const QString &sourcePath, bool *written) const
+{
+    MemoryImage memoryImage;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        QHash<QString, QImage>::const_iterator it = m_queuedImages.constFind(path);
+        if (it != m_queuedImages.constEnd()) {
+            *written = true;
+            return *it;
+        }
+
+        memoryImage = m_memoryImages.value(path, { QImage(), 0 });
+        if (memoryImage.image.isNull()) {
+            return QImage();
+        }
+    }
+
+    // Held in place of an entry on disk, so compare it against the source as an entry would be.
+    if (QFileInfo(sourcePath).lastModified().toMSecsSinceEpoch() > memoryImage.created) {
+        return QImage();
+    }
+
+    *written = false;
+    return memoryImage.image;
+}
+
+void NemoThumbnailWriter::run()
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (;;) {
+        if (m_queue.isEmpty()) {
+            if (m_quit) {
+                return;
+            }
+            m_waitCondition.wait(&m_mutex);
+            continue;
+        }
+
+        QList<Entry> batch;
+        while (!m_queue.isEmpty() && batch.count() < MaximumBatchSize) {
+            batch.append(m_queue.takeFirst());
+        }
+
+        locker.unlock();
+
+        // Encode everything before syncing anything so the kernel can merge the writes, then
+        // only publish entries once their data is on disk.
+        QVector<QFile *> files;
+        files.reserve(batch.count());
+        for (const Entry &entry : batch) {
+            QFile *file = new QFile(temporaryPath(entry.path));
+            if (!file->open(QIODevice::WriteOnly)
+                    || !encode(file, entry.image)
+                    || !file->flush()) {
+                qCWarning(thumbnailer) << "Couldn't cache to" << entry.path << file->errorString();
+                file->close();
+                file->remove();
+                delete file;
+                file = nullptr;
+            }
+            files.append(file);
+        }
+
+        QVector<bool> published(batch.count(), false);
+        for (int i = 0; i < batch.count(); ++i) {
+            if (QFile *file = files.at(i)) {
+                const bool synced = ::fdatasync(file->handle()) == 0;
+                file->close();
+
+                if (synced && file->error() == QFileDevice::NoError) {
+                    published[i] = publish(file->fileName(), batch.at(i).path);
+                } else {
+                    file->remove();
+                }
+                delete file;
+            }
+        }
+
+        locker.relock();
+
+        for (int i = 0; i < batch.count(); ++i) {
+            const Entry &entry = batch.at(i);
+            m_queuedBytes -= imageBytes(entry.image);
+
+            // The entry may have been replaced by a newer thumbnail while it was being written.
+            const QHash<QString, QImage>::iterator queued = m_queuedImages.find(entry.path);
+            const bool current = queued != m_queuedImages.end()
+                    && queued->cacheKey() == entry.image.cacheKey();
+            if (current) {
+                m_queuedImages.erase(queued);
+            }
+
+            if (!published.at(i)) {
+                // Most likely the disk is full, stop trying for a while and keep thumbnails in
+                // memory instead.
+                m_memoryOnlyUntil = QDateTime::currentMSecsSinceEpoch() + MemoryOnlyInterval;
+                if (current) {
+                    storeInMemory(entry.path, entry.image, entry.created);
+                }
+            }
+        }
+
+        m_writtenCondition.wakeAll();
+    }
+}
+
+void NemoThumbnailWriter::waitForWritten(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_queuedImages.contains(path)) {
+        m_writtenCondition.wait(&m_mutex);
+    }
+}
+
+void NemoThumbnailWriter::storeInMemory(const QString &path, const QImage &image, qint64 created)
+{
+    QHash<QString, MemoryImage>::iterator it = m_memoryImages.find(path);
+    if (it != m_memoryImages.end()) {
+        m_memoryBytes -= imageBytes(it->image);
+        m_memoryOrder.removeOne(path);
+    }
+
+    m_memoryImages.insert(path, { image, created });
+    m_memoryOrder.append(path);
+    m_memoryBytes += imageBytes(image);
+
+    while (m_memoryBytes > MaximumMemoryBytes && !m_memoryOrder.isEmpty()) {
+        m_memoryBytes -= imageBytes(m_memoryImages.take(m_memoryOrder.takeFirst()).image);
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef NEMOTHUMBNAILWRITER_P_H
+#define NEMOTHUMBNAILWRITER_P_H
+
+#include <nemothumbnailexports.h>
+
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+// Writes generated thumbnails to the cache on a low priority thread so encoding and disk I/O
+// are off the path that returns the image to the caller.
+//
+// Entries are written to a temporary file and renamed into place once the data has been synced
+// so readers never see a partially written entry, and syncs are batched across all entries
+// written together.  Until an entry has been written its image is served from memory.  If the
+// writer falls too far behind or writing fails, for example because the disk is full, new
+// thumbnails are only kept in a bounded memory cache.
+class NEMO_QML_PLUGIN_THUMBNAILER_EXPORT NemoThumbnailWriter : public QThread
+{
+public:
+    NemoThumbnailWriter();
+    ~NemoThumbnailWriter();
+
+    static NemoThumbnailWriter *instance();
+
+    // Encodes image in the format used for cache entries.
+    static bool encode(QIODevice *device, const QImage &image);
+
+    // Writes an entry synchronously, replacing any existing entry atomically.
+    static bool write(const QString &path, const QImage &image);
+
+    // Queues an entry to be written, returns false if it will only be held in memory.  An entry
+    // already queued for the path is replaced.
+    bool enqueue(const QString &path, const QImage &image);
+
+    // Returns the image of an entry which is queued for writing or only held in memory, unless
+    // it is held in memory and sourcePath was modified after it was generated.  written is set
+    // to whether the entry will be available on disk.
+    QImage pendingImage(const QString &path, const QString &sourcePath, bool *written) const;
+
+    // Blocks until a queued entry has been written or moved to memory.
+    void waitForWritten(const QString &path);
+
+protected:
+    void run() override;
+
+private:
+    struct Entry
+    {
+        QString path;
+        QImage image;
+        qint64 created;
+    };
+
+    struct MemoryImage
+    {
+        QImage image;
+        qint64 created;
+    };
+
+    void storeInMemory(const QString &path, const QImage &image, qint64 created);
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_waitCondition;
+    QWaitCondition m_writtenCondition;
+    QList<Entry> m_queue;
+    QHash<QString, QImage> m_queuedImages;
+    QHash<QString, MemoryImage> m_memoryImages;
+    QList<QString> m_memoryOrder;
+    qint64 m_queuedBytes;
+    qint64 m_memoryBytes;
+    qint64 m_memoryOnlyUntil;
+    bool m_quit;
+};
+
+#endif // NEMOTHUMBNAILWRITER_P_H
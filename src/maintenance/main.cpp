@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QTextStream>
+
+#include "nemothumbnailmaintenance.h"
+#include "nemothumbnailprotocol_p.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+                "Inspects and maintains the thumbnail cache.\n\n"
+                "Commands:\n"
+                "  stats    Count entries and bytes by size and format.\n"
+                "  verify   Find empty, corrupt, orphaned, stale and temporary entries.\n"
+                "  prune    Remove the entries verify finds and evict the oldest entries\n"
+                "           beyond --max-size.\n"
+                "  compact  Prune, then rewrite entries in legacy formats and remove empty\n"
+                "           directories."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("command"), QStringLiteral("stats, verify, prune or compact."));
+
+    const QCommandLineOption dryRunOption(QStringLiteral("dry-run"),
+                QStringLiteral("Report what prune or compact would change as JSON without changing anything."));
+    const QCommandLineOption jsonOption(QStringLiteral("json"),
+                QStringLiteral("Write the report as JSON."));
+    const QCommandLineOption maxSizeOption(QStringLiteral("max-size"),
+                QStringLiteral("Evict the oldest entries until the cache is no larger than this."),
+                QStringLiteral("MiB"));
+    const QCommandLineOption cacheOption(QStringLiteral("cache"),
+                QStringLiteral("The cache directory."), QStringLiteral("path"),
+                NemoThumbnailProtocol::cachePath());
+    parser.addOptions({ dryRunOption, jsonOption, maxSizeOption, cacheOption });
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    const QString command = arguments.value(0);
+    if (arguments.count() != 1) {
+        parser.showHelp(EXIT_FAILURE);
+    }
+
+    const bool dryRun = parser.isSet(dryRunOption);
+    const qint64 maximumBytes = parser.value(maxSizeOption).toLongLong() << 20;
+
+    NemoThumbnailMaintenance maintenance(parser.value(cacheOption));
+
+    NemoThumbnailMaintenance::Report report;
+    if (command == QLatin1String("stats")) {
+        report = maintenance.stats();
+    } else if (command == QLatin1String("verify")) {
+        report = maintenance.verify();
+    } else if (command == QLatin1String("prune")) {
+        report = maintenance.prune(dryRun, maximumBytes);
+    } else if (command == QLatin1String("compact")) {
+        report = maintenance.compact(dryRun, maximumBytes);
+    } else {
+        QTextStream(stderr) << "Unknown command " << command << endl;
+        return EXIT_FAILURE;
+    }
+
+    QTextStream out(stdout);
+    if (dryRun || parser.isSet(jsonOption)) {
+        out << QJsonDocument(report.toJson()).toJson();
+    } else {
+        out << report.toText();
+    }
+
+    // Lets scripts check the cache with verify.
+    return command == QLatin1String("verify") && !report.problems.isEmpty()
+            ? EXIT_FAILURE
+            : EXIT_SUCCESS;
+}
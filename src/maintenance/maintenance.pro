@@ -0,0 +1,24 @@
+TEMPLATE = app
+TARGET = nemo-thumbnailer-cache
+
+CONFIG += c++17
+
+INCLUDEPATH += ../lib
+LIBS += -L../lib -lnemothumbnailer-qt$${QT_MAJOR_VERSION}
+
+SOURCES += \
+    main.cpp \
+    nemothumbnailmaintenance.cpp \
+    ../lib/nemoqoicodec.cpp
+HEADERS += \
+    nemothumbnailmaintenance.h \
+    ../lib/nemoqoicodec_p.h
+
+target.path = /usr/bin
+
+service.files = \
+    nemo-thumbnailer-maintenance.service \
+    nemo-thumbnailer-maintenance.timer
+service.path = /usr/lib/systemd/user
+
+INSTALLS += target service
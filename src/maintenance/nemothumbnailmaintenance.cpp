@@ -0,0 +1,475 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include "nemothumbnailmaintenance.h"
+
+#include "nemoqoicodec_p.h"
+#include "nemothumbnailprotocol_p.h"
+#include "nemothumbnailwriter_p.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QImageReader>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QUrl>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char * const problemNames[] = {
+    "none", "empty", "corrupt", "orphaned", "stale", "temporary", "over-budget"
+};
+
+QByteArray formatName(const QByteArray &magic)
+{
+    if (magic.startsWith("\xff\xd8")) {
+        return "jpeg";
+    } else if (magic.startsWith("\x89PNG")) {
+        return "png";
+    } else if (magic.startsWith("qoif")) {
+        return "qoi";
+    } else {
+        return "unknown";
+    }
+}
+
+// Reads the sources in the directories the daemon watches by the hash of their path, returns
+// false if the daemon has never saved them.
+bool readWatchedSources(const QString &cachePath, QHash<QByteArray, QString> *sources)
+{
+    QFile file(NemoThumbnailProtocol::watchedSourcesPath(cachePath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        const QString path = QFile::decodeName(line.left(line.length() - 1));
+        sources->insert(NemoThumbnailProtocol::sourceHash(path), path);
+    }
+    return true;
+}
+
+bool processRunning(pid_t pid)
+{
+    return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+}
+
+QJsonObject bucketToJson(const NemoThumbnailMaintenance::Bucket &bucket)
+{
+    return QJsonObject {
+        { QStringLiteral("count"), bucket.count },
+        { QStringLiteral("bytes"), double(bucket.bytes) }
+    };
+}
+
+QJsonObject bucketsToJson(const QMap<QString, NemoThumbnailMaintenance::Bucket> &buckets)
+{
+    QJsonObject object;
+    for (auto it = buckets.cbegin(); it != buckets.cend(); ++it) {
+        object.insert(it.key(), bucketToJson(it.value()));
+    }
+    return object;
+}
+
+}
+
+NemoThumbnailMaintenance::NemoThumbnailMaintenance(const QString &cachePath)
+    : m_cachePath(cachePath)
+{
+}
+
+const char *NemoThumbnailMaintenance::problemName(Problem problem)
+{
+    return problemNames[problem];
+}
+
+NemoThumbnailMaintenance::Report NemoThumbnailMaintenance::stats()
+{
+    Report report;
+    report.command = QStringLiteral("stats");
+    summarize(&report, scan(false), false);
+    return report;
+}
+
+NemoThumbnailMaintenance::Report NemoThumbnailMaintenance::verify()
+{
+    Report report;
+    report.command = QStringLiteral("verify");
+    summarize(&report, scan(true), true);
+    return report;
+}
+
+NemoThumbnailMaintenance::Report NemoThumbnailMaintenance::prune(bool dryRun, qint64 maximumBytes)
+{
+    Report report;
+    report.command = QStringLiteral("prune");
+    report.dryRun = dryRun;
+    pruneEntries(&report, maximumBytes);
+    return report;
+}
+
+NemoThumbnailMaintenance::Report NemoThumbnailMaintenance::compact(bool dryRun, qint64 maximumBytes)
+{
+    Report report;
+    report.command = QStringLiteral("compact");
+    report.dryRun = dryRun;
+
+    // Entries written as PNG by earlier versions decode several times slower than the current
+    // formats.
+    for (const Entry &entry : pruneEntries(&report, maximumBytes)) {
+        if (entry.format == "png" && (dryRun || recompress(entry))) {
+            ++report.recompressed;
+        }
+    }
+
+    if (!dryRun) {
+        QDir cache(m_cachePath);
+        for (const QString &shard : cache.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            cache.rmdir(shard);     // Fails unless empty.
+        }
+    }
+
+    return report;
+}
+
+QVector<NemoThumbnailMaintenance::Entry> NemoThumbnailMaintenance::pruneEntries(
+        Report *report, qint64 maximumBytes)
+{
+    const QVector<Entry> entries = scan(true);
+    summarize(report, entries, true);
+
+    QVector<Entry> kept;
+    qint64 keptBytes = 0;
+    for (const Entry &entry : entries) {
+        if (entry.problem != NoProblem) {
+            remove(report, entry);
+        } else {
+            kept.append(entry);
+            keptBytes += entry.bytes;
+        }
+    }
+
+    if (maximumBytes > 0 && keptBytes > maximumBytes) {
+        std::sort(kept.begin(), kept.end(), [](const Entry &left, const Entry &right) {
+            return left.modified < right.modified;
+        });
+
+        int evicted = 0;
+        for (; evicted < kept.count() && keptBytes > maximumBytes; ++evicted) {
+            Entry entry = kept.at(evicted);
+            entry.problem = OverBudget;
+            report->problems.append(entry);
+            remove(report, entry);
+            keptBytes -= entry.bytes;
+        }
+        kept.remove(0, evicted);
+    }
+
+    return kept;
+}
+
+QVector<NemoThumbnailMaintenance::Entry> NemoThumbnailMaintenance::scan(bool verify)
+{
+    static const QRegularExpression keyPattern(QStringLiteral("^([0-9a-f]{40})-(?:s([0-9]+)x)?([0-9]+)(F?)$"));
+    static const QRegularExpression temporaryPattern(QStringLiteral("\\.tmp-([0-9]+)-[0-9]+$"));
+
+    QVector<Entry> entries;
+
+    // Read when an entry recording a different source than its key is first found.
+    QHash<QByteArray, QString> watchedSources;
+    bool watchedSourcesRead = false;
+    bool watchedSourcesKnown = false;
+
+    const QDir cache(m_cachePath);
+    for (const QString &shard : cache.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        const QDir directory(cache.filePath(shard));
+        for (const QFileInfo &info : directory.entryInfoList(QDir::Files | QDir::Hidden)) {
+            const QString name = info.fileName();
+
+            Entry entry;
+            entry.path = info.filePath();
+            entry.bytes = info.size();
+            entry.modified = info.lastModified().toMSecsSinceEpoch();
+
+            const QRegularExpressionMatch temporary = temporaryPattern.match(name);
+            if (temporary.hasMatch()) {
+                // Files still being written by a running process are left alone.
+                if (!processRunning(temporary.captured(1).toInt())) {
+                    entry.problem = Temporary;
+                    entries.append(entry);
+                }
+                continue;
+            }
+
+            const QRegularExpressionMatch key = keyPattern.match(name);
+            if (!key.hasMatch() || !name.startsWith(shard)) {
+                entry.problem = Corrupt;
+                entries.append(entry);
+                continue;
+            }
+            entry.frames = key.captured(2).toInt();
+            entry.size = key.captured(3).toInt();
+            entry.crop = key.capturedRef(4).isEmpty();
+
+            QFile file(entry.path);
+            if (entry.bytes == 0) {
+                entry.problem = Empty;
+            } else if (!file.open(QIODevice::ReadOnly)) {
+                entry.problem = Corrupt;
+            } else {
+                entry.format = formatName(file.peek(4));
+            }
+
+            if (verify && entry.problem == NoProblem) {
+                QString uri;
+                QString modified;
+                bool decoded = false;
+                if (entry.format == "qoi") {
+                    const QMap<QString, QString> text = NemoQoiCodec::readText(&file);
+                    uri = text.value(QStringLiteral("Thumb::URI"));
+                    modified = text.value(QStringLiteral("Thumb::MTime"));
+                    decoded = !NemoQoiCodec::read(&file).isNull();
+                } else {
+                    QImageReader reader(&file);
+                    uri = reader.text(QStringLiteral("Thumb::URI"));
+                    modified = reader.text(QStringLiteral("Thumb::MTime"));
+                    decoded = !reader.read().isNull();
+                }
+
+                entry.source = QUrl(uri).toLocalFile();
+
+                // The daemon renames the entries of a renamed source to the key of its new path
+                // without rewriting the source they record, look the new path up among the
+                // sources it watches.
+                const QByteArray hash = key.capturedRef(1).toLatin1();
+                bool renamed = false;
+                if (!entry.source.isEmpty() && NemoThumbnailProtocol::sourceHash(entry.source) != hash) {
+                    if (!watchedSourcesRead) {
+                        watchedSourcesKnown = readWatchedSources(m_cachePath, &watchedSources);
+                        watchedSourcesRead = true;
+                    }
+                    entry.source = watchedSources.value(hash);
+                    renamed = true;
+                }
+
+                const QFileInfo source(entry.source);
+                if (!decoded) {
+                    entry.problem = Corrupt;
+                } else if (entry.source.isEmpty()) {
+                    // Written before sources were recorded, or renamed to a source the daemon no
+                    // longer watches.
+                    if (renamed && watchedSourcesKnown) {
+                        entry.problem = Orphaned;
+                    }
+                } else if (!source.exists()) {
+                    entry.problem = Orphaned;
+                } else if (!modified.isEmpty()
+                           ? source.lastModified().toSecsSinceEpoch() != modified.toLongLong()
+                           : source.lastModified().toMSecsSinceEpoch() > entry.modified) {
+                    entry.problem = Stale;
+                }
+            }
+
+            entries.append(entry);
+        }
+    }
+
+    return entries;
+}
+
+void NemoThumbnailMaintenance::summarize(
+        Report *report, const QVector<Entry> &entries, bool verified) const
+{
+    for (const Entry &entry : entries) {
+        if (entry.problem != NoProblem) {
+            report->problems.append(entry);
+        }
+        if (entry.problem == Temporary || entry.size == 0) {
+            continue;
+        }
+
+        const QString size = (entry.frames > 0 ? QStringLiteral("s%1x").arg(entry.frames) : QString())
+                + QString::number(entry.size) + (entry.crop ? QString() : QStringLiteral("F"));
+        const QString format = QString::fromLatin1(entry.format.isEmpty() ? QByteArray("none") : entry.format);
+
+        for (Bucket *bucket : { &report->total, &report->sizes[size], &report->formats[format] }) {
+            ++bucket->count;
+            bucket->bytes += entry.bytes;
+        }
+
+        if (verified && entry.problem == NoProblem && entry.source.isEmpty()) {
+            ++report->unknownSources;
+        }
+    }
+}
+
+void NemoThumbnailMaintenance::remove(Report *report, const Entry &entry)
+{
+    if (report->dryRun || QFile::remove(entry.path)) {
+        ++report->removed;
+        report->bytesFreed += entry.bytes;
+    }
+}
+
+bool NemoThumbnailMaintenance::recompress(const Entry &entry)
+{
+    QImageReader reader(entry.path);
+    const QImage image = reader.read();
+    if (image.isNull()) {
+        return false;
+    }
+
+    // Write beside the entry and replace it atomically, as the writer in the library does.
+    const QString temporaryPath = entry.path + QLatin1String(".tmp-")
+            + QString::number(QCoreApplication::applicationPid()) + QLatin1String("-0");
+
+    QFile file(temporaryPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    // Encode as the library would write the entry now.
+    const bool encoded = NemoThumbnailWriter::encode(&file, image);
+    file.close();
+
+    const QByteArray temporary = QFile::encodeName(temporaryPath);
+
+    // Keep the modification time, lookups compare it with the source's.
+    struct timespec times[2];
+    times[0].tv_sec = 0;
+    times[0].tv_nsec = UTIME_OMIT;
+    times[1].tv_sec = entry.modified / 1000;
+    times[1].tv_nsec = (entry.modified % 1000) * 1000000;
+
+    if (!encoded
+            || file.error() != QFileDevice::NoError
+            || ::utimensat(AT_FDCWD, temporary.constData(), times, 0) != 0
+            || ::rename(temporary.constData(), QFile::encodeName(entry.path).constData()) != 0) {
+        QFile::remove(temporaryPath);
+        return false;
+    }
+    return true;
+}
+
+QJsonObject NemoThumbnailMaintenance::Report::toJson() const
+{
+    QJsonArray problemList;
+    for (const Entry &entry : problems) {
+        QJsonObject object {
+            { QStringLiteral("path"), entry.path },
+            { QStringLiteral("problem"), QString::fromLatin1(problemName(entry.problem)) },
+            { QStringLiteral("bytes"), double(entry.bytes) }
+        };
+        if (entry.size > 0) {
+            object.insert(QStringLiteral("size"), entry.size);
+            object.insert(QStringLiteral("crop"), entry.crop);
+            if (entry.frames > 0) {
+                object.insert(QStringLiteral("frames"), entry.frames);
+            }
+        }
+        if (!entry.format.isEmpty()) {
+            object.insert(QStringLiteral("format"), QString::fromLatin1(entry.format));
+        }
+        if (!entry.source.isEmpty()) {
+            object.insert(QStringLiteral("source"), entry.source);
+        }
+        problemList.append(object);
+    }
+
+    QJsonObject object {
+        { QStringLiteral("command"), command },
+        { QStringLiteral("total"), bucketToJson(total) },
+        { QStringLiteral("sizes"), bucketsToJson(sizes) },
+        { QStringLiteral("formats"), bucketsToJson(formats) }
+    };
+    if (command != QLatin1String("stats")) {
+        object.insert(QStringLiteral("unknownSources"), unknownSources);
+        object.insert(QStringLiteral("problems"), problemList);
+    }
+    if (command == QLatin1String("prune") || command == QLatin1String("compact")) {
+        object.insert(QStringLiteral("dryRun"), dryRun);
+        object.insert(QStringLiteral("removed"), removed);
+        object.insert(QStringLiteral("bytesFreed"), double(bytesFreed));
+    }
+    if (command == QLatin1String("compact")) {
+        object.insert(QStringLiteral("recompressed"), recompressed);
+    }
+    return object;
+}
+
+QString NemoThumbnailMaintenance::Report::toText() const
+{
+    QString text;
+    QTextStream stream(&text);
+
+    stream << "Entries: " << total.count << ", " << total.bytes << " bytes\n";
+    for (auto it = sizes.cbegin(); it != sizes.cend(); ++it) {
+        stream << "  size " << it.key() << ": " << it->count << ", " << it->bytes << " bytes\n";
+    }
+    for (auto it = formats.cbegin(); it != formats.cend(); ++it) {
+        stream << "  format " << it.key() << ": " << it->count << ", " << it->bytes << " bytes\n";
+    }
+
+    if (command != QLatin1String("stats")) {
+        stream << "Entries with no recorded source: " << unknownSources << '\n';
+
+        QMap<Problem, int> counts;
+        for (const Entry &entry : problems) {
+            ++counts[entry.problem];
+        }
+        for (auto it = counts.cbegin(); it != counts.cend(); ++it) {
+            stream << "  " << problemName(it.key()) << ": " << it.value() << '\n';
+        }
+    }
+    if (command == QLatin1String("prune") || command == QLatin1String("compact")) {
+        stream << "Removed: " << removed << ", " << bytesFreed << " bytes\n";
+    }
+    if (command == QLatin1String("compact")) {
+        stream << "Recompressed: " << recompressed << '\n';
+    }
+
+    return text;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#ifndef NEMOTHUMBNAILMAINTENANCE_H
+#define NEMOTHUMBNAILMAINTENANCE_H
+
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+// Inspects and repairs the thumbnail cache while nothing else is using it.
+//
+// Entries record their source with the Thumb::URI and Thumb::MTime text of the freedesktop.org
+// thumbnail specification, entries written before that was added have no known source and are
+// only checked for corruption.  Entries the daemon renamed along with their source still record
+// the old path and are checked against the new one from the list of sources it watches.
+class NemoThumbnailMaintenance
+{
+public:
+    enum Problem {
+        NoProblem,
+        Empty,          // The entry has no content.
+        Corrupt,        // The entry can't be decoded or isn't named like an entry.
+        Orphaned,       // The source no longer exists.
+        Stale,          // The source was modified after the entry was generated.
+        Temporary,      // An unpublished entry left behind by a writer which has exited.
+        OverBudget      // Evicted to bring the cache within its size limit.
+    };
+
+    struct Entry
+    {
+        QString path;
+        QString source;
+        QByteArray format;
+        qint64 bytes = 0;
+        qint64 modified = 0;
+        int size = 0;
+        // Frames of a video strip entry, or 0 for a thumbnail.
+        int frames = 0;
+        bool crop = true;
+        Problem problem = NoProblem;
+    };
+
+    struct Bucket
+    {
+        int count = 0;
+        qint64 bytes = 0;
+    };
+
+    struct Report
+    {
+        QString command;
+        bool dryRun = false;
+        Bucket total;
+        QMap<QString, Bucket> sizes;
+        QMap<QString, Bucket> formats;
+        int unknownSources = 0;
+        QVector<Entry> problems;
+        int removed = 0;
+        int recompressed = 0;
+        qint64 bytesFreed = 0;
+
+        QJsonObject toJson() const;
+        QString toText() const;
+    };
+
+    explicit NemoThumbnailMaintenance(const QString &cachePath);
+
+    // Counts the entries by size and format.
+    Report stats();
+    // Additionally decodes every entry and checks it against its source.
+    Report verify();
+    // Verifies and removes the entries with problems, then the least recently generated entries
+    // until the cache is no larger than maximumBytes if that is positive.
+    Report prune(bool dryRun, qint64 maximumBytes);
+    // Prunes, then rewrites entries stored in legacy formats in the current format and removes
+    // empty directories.
+    Report compact(bool dryRun, qint64 maximumBytes);
+
+    static const char *problemName(Problem problem);
+
+private:
+    QVector<Entry> pruneEntries(Report *report, qint64 maximumBytes);
+    QVector<Entry> scan(bool verify);
+    void summarize(Report *report, const QVector<Entry> &entries, bool verified) const;
+    void remove(Report *report, const Entry &entry);
+    bool recompress(const Entry &entry);
+
+    QString m_cachePath;
+};
+
+#endif // NEMOTHUMBNAILMAINTENANCE_H
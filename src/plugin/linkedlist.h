@@ -145,7 +145,7 @@ private:
     {
         node->erase();
 
-        after->previous->next = after->next;
+        after->next->previous = node;
         node->next = after->next;
         node->previous = after;
         after->next = node;
@@ -33,18 +33,60 @@
 #include "nemothumbnailitem.h"
 
 #include "nemothumbnailcache.h"
+#include "nemothumbnailprotocol_p.h"
+#include "nemothumbnailrecorder.h"
+#include "nemothumbnailtrace_p.h"
 
 #include "linkedlist.h"
 
 #include <QCoreApplication>
+#include <QFile>
+#include <QMetaMethod>
+#include <QVarLengthArray>
 
 #include <QSGSimpleTextureNode>
 #include <QQuickWindow>
 
+#include <algorithm>
+#include <atomic>
+
 namespace {
 
 template <typename T, int N> int lengthOf(const T(&)[N]) { return N; }
 
+int countRequests(ThumbnailRequestList *list)
+{
+    int count = 0;
+    for (ThumbnailRequestList::iterator it = list->begin(); it != list->end(); ++it)
+        ++count;
+    return count;
+}
+
+std::atomic<qint64> *busyState()
+{
+    static std::atomic<qint64> * const state = NemoThumbnailProtocol::mapBusyState(true);
+    return state;
+}
+
+// Lets background thumbnail generation know the loader is busy so it can back off.
+void markBusy()
+{
+    if (std::atomic<qint64> * const state = busyState())
+        state->store(NemoThumbnailProtocol::monotonicTime(), std::memory_order_relaxed);
+}
+
+const int StatisticsInterval = 1000;
+// Requests loaded from the cache together, enough for a screenful of a dense grid.
+const int MaximumProbeBatch = 64;
+
+// The size of a single frame of a strip, or of the whole image otherwise.
+QSize frameSize(const ThumbnailRequest *request, const QSize &imageSize)
+{
+    return request->stripFrames > 0
+            ? NemoThumbnailCache::stripFrame(imageSize, request->stripFrames, 0).size()
+            : imageSize;
+}
+
 int thumbnailerMaxCost()
 {
     const QByteArray costEnv = qgetenv("NEMO_THUMBNAILER_CACHE_SIZE");
@@ -57,19 +99,25 @@ int thumbnailerMaxCost()
 int MaximumSaneSize = 10000;
 }
 
-ThumbnailRequest::ThumbnailRequest(NemoThumbnailItem *item, const QString &fileName, uint cacheKey)
+ThumbnailRequest::ThumbnailRequest(NemoThumbnailItem *item, const ThumbnailRequestKey &cacheKey, bool timed)
     : cacheKey(cacheKey)
-    , fileName(fileName)
+    , fileName(cacheKey.fileName)
     , mimeType(item->m_mimeType)
     , size(item->m_sourceSize)
+    , stripFrames(item->m_stripFrames)
     , texture(0)
     , fillMode(item->m_fillMode)
     , status(NemoThumbnailItem::Loading)
     , priority(NemoThumbnailItem::Unprioritized)
     , loading(false)
     , loaded(false)
+    , placeholder(false)
+    , refining(false)
     , cacheCost(0)
+    , trace(timed ? new qint64[NemoThumbnailTrace::StageCount]() : nullptr)
 {
+    if (trace)
+        trace[NemoThumbnailTrace::Queued] = NemoThumbnailTrace::timestamp();
 }
 
 ThumbnailRequest::~ThumbnailRequest()
@@ -77,8 +125,10 @@ ThumbnailRequest::~ThumbnailRequest()
     if (texture) {
         texture->deleteLater();
     }
+    delete [] trace;
 }
 
+
 /*!
     \qmltype Thumbnail
     \inqmlmodule Nemo.Thumbnailer
@@ -117,6 +167,8 @@ NemoThumbnailItem::NemoThumbnailItem(QQuickItem *parent)
     , m_request(0)
     , m_priority(NormalPriority)
     , m_fillMode(PreserveAspectCrop)
+    , m_stripFrames(0)
+    , m_frame(0)
     , m_imageChanged(false)
 {
     setFlag(QQuickItem::ItemHasContents, true);
@@ -124,6 +176,9 @@ NemoThumbnailItem::NemoThumbnailItem(QQuickItem *parent)
 
 NemoThumbnailItem::~NemoThumbnailItem()
 {
+    if (NemoThumbnailRecorder::isEnabled() && isComponentComplete())
+        NemoThumbnailRecorder::itemDestroyed(this);
+
     if (m_request)
         m_loader->cancelRequest(this);
 }
@@ -132,6 +187,9 @@ void NemoThumbnailItem::componentComplete()
 {
     QQuickItem::componentComplete();
 
+    if (NemoThumbnailRecorder::isEnabled())
+        NemoThumbnailRecorder::itemCreated(this);
+
     updateThumbnail(true);
 }
 
@@ -264,6 +322,50 @@ NemoThumbnailItem::Status NemoThumbnailItem::status() const
     return m_request ? m_request->status : Null;
 }
 
+/*!
+    \qmlproperty int Thumbnail::stripFrames
+
+    Set this property to show a frame of a strip of \a stripFrames frames evenly spaced through
+    a video instead of a single thumbnail, for example to preview the position when scrubbing.
+    All the frames are loaded as a single image so changing the \l frame shown is cheap.  Each
+    frame is scaled to fit within sourceSize.
+
+    The default value is 0, which shows a single thumbnail.
+*/
+int NemoThumbnailItem::stripFrames() const
+{
+    return m_stripFrames;
+}
+
+void NemoThumbnailItem::setStripFrames(int frames)
+{
+    if (m_stripFrames != frames) {
+        m_stripFrames = frames;
+        emit stripFramesChanged();
+        updateThumbnail(true);
+    }
+}
+
+/*!
+    \qmlproperty int Thumbnail::frame
+
+    This property holds the index of the frame shown when \l stripFrames is set.
+*/
+int NemoThumbnailItem::frame() const
+{
+    return m_frame;
+}
+
+void NemoThumbnailItem::setFrame(int frame)
+{
+    if (m_frame != frame) {
+        m_frame = frame;
+        emit frameChanged();
+        if (m_stripFrames > 0)
+            update();
+    }
+}
+
 QSGNode *NemoThumbnailItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 {
     QSGSimpleTextureNode *node = static_cast<QSGSimpleTextureNode *>(oldNode);
@@ -279,6 +381,11 @@ QSGNode *NemoThumbnailItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
         delete m_request->texture;
         m_request->texture = window()->createTextureFromImage(m_request->pixmap, QQuickWindow::TextureCanUseAtlas);
         m_request->pixmap = QImage();
+
+        if (m_request->trace && !m_request->refining) {
+            m_request->trace[NemoThumbnailTrace::Uploaded] = NemoThumbnailTrace::timestamp();
+            m_loader->finishTiming(m_request);
+        }
     }
 
     if (m_imageChanged || !node->texture()) {
@@ -286,7 +393,17 @@ QSGNode *NemoThumbnailItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
         node->setTexture(m_request->texture);
     }
 
-    QRectF rect(QPointF(0, 0), m_request->texture->textureSize().scaled(
+    QSize textureSize = m_request->texture->textureSize();
+    if (m_request->stripFrames > 0) {
+        const QRect frame = NemoThumbnailCache::stripFrame(
+                    textureSize, m_request->stripFrames, qBound(0, m_frame, m_request->stripFrames - 1));
+        node->setSourceRect(frame);
+        textureSize = frame.size();
+    } else {
+        node->setSourceRect(QRectF());
+    }
+
+    QRectF rect(QPointF(0, 0), textureSize.scaled(
                 width(),
                 height(),
                 m_fillMode == PreserveAspectFit ? Qt::KeepAspectRatio : Qt::KeepAspectRatioByExpanding));
@@ -368,6 +485,16 @@ NemoThumbnailLoader::NemoThumbnailLoader(QQuickWindow *window)
     , m_window(window)
     , m_totalCost(0)
     , m_maxCost(thumbnailerMaxCost())
+    , m_latencySampleIndex(0)
+    , m_latencySampleCount(0)
+    , m_diskHits(0)
+    , m_diskMisses(0)
+    , m_statisticsChanged(true)
+    , m_latenciesCollected(false)
+    , m_memoryHits(0)
+    , m_memoryMisses(0)
+    , m_peakCost(0)
+    , m_wastedLoads(0)
     , m_quit(false)
     , m_suspend(false)
 {
@@ -377,6 +504,8 @@ NemoThumbnailLoader::NemoThumbnailLoader(QQuickWindow *window)
     connect(window, &QQuickWindow::sceneGraphInvalidated,
                 this, &NemoThumbnailLoader::destroyTextures,
                 Qt::DirectConnection);
+
+    updateStatistics();
 }
 
 NemoThumbnailLoader::~NemoThumbnailLoader()
@@ -390,21 +519,9 @@ NemoThumbnailLoader::~NemoThumbnailLoader()
 
     wait();
 
-    ThumbnailRequestList *lists[] = {
-        &m_thumbnailHighPriority,
-        &m_thumbnailNormalPriority,
-        &m_thumbnailLowPriority,
-        &m_generateHighPriority,
-        &m_generateNormalPriority,
-        &m_generateLowPriority,
-        &m_completedRequests,
-        &m_cachedRequests
-    };
-
-    for (int i = 0; i < lengthOf(lists); ++i) {
-        while (ThumbnailRequest *request = lists[i]->takeFirst())
-            delete request;
-    }
+    // Every request is in the request cache, including those shown by items which aren't in
+    // any list.
+    qDeleteAll(m_requestCache.requests());
 }
 
 int NemoThumbnailLoader::maxCost() const
@@ -420,6 +537,206 @@ void NemoThumbnailLoader::setMaxCost(int cost)
     }
 }
 
+NemoThumbnailLoader::Statistics NemoThumbnailLoader::statistics()
+{
+    Statistics statistics;
+    statistics.memoryHits = m_memoryHits;
+    statistics.memoryMisses = m_memoryMisses;
+    statistics.totalCost = m_totalCost;
+    statistics.peakCost = m_peakCost;
+    statistics.wastedLoads = m_wastedLoads;
+
+    QMutexLocker locker(&m_mutex);
+
+    statistics.diskHits = m_diskHits;
+    statistics.diskMisses = m_diskMisses;
+    statistics.generations = m_generations;
+
+    ThumbnailRequestList *lists[][NemoThumbnailItem::PriorityCount] = {
+        { &m_thumbnailHighPriority, &m_thumbnailNormalPriority, &m_thumbnailLowPriority },
+        { &m_generateHighPriority, &m_generateNormalPriority, &m_generateLowPriority }
+    };
+    for (int priority = 0; priority < NemoThumbnailItem::PriorityCount; ++priority) {
+        statistics.loadQueueDepth[priority] = countRequests(lists[0][priority]);
+        statistics.generateQueueDepth[priority] = countRequests(lists[1][priority]);
+    }
+
+    for (int stage = 0; stage < NemoThumbnailTrace::StageCount; ++stage) {
+        QVarLengthArray<qint32, LatencySampleCount> samples;
+        for (int i = 0; i < m_latencySampleCount; ++i) {
+            if (m_latencySamples[stage][i] >= 0)
+                samples.append(m_latencySamples[stage][i]);
+        }
+
+        if (!samples.isEmpty()) {
+            qint32 * const p50 = samples.begin() + (samples.count() - 1) * 50 / 100;
+            std::nth_element(samples.begin(), p50, samples.end());
+            statistics.stageP50[stage] = *p50 / 1000.0;
+
+            qint32 * const p95 = samples.begin() + (samples.count() - 1) * 95 / 100;
+            std::nth_element(samples.begin(), p95, samples.end());
+            statistics.stageP95[stage] = *p95 / 1000.0;
+        }
+    }
+
+    return statistics;
+}
+
+qreal NemoThumbnailLoader::Statistics::memoryHitRate() const
+{
+    return memoryHits > 0 ? qreal(memoryHits) / (memoryHits + memoryMisses) : 0;
+}
+
+qreal NemoThumbnailLoader::Statistics::diskHitRate() const
+{
+    return diskHits > 0 ? qreal(diskHits) / (diskHits + diskMisses) : 0;
+}
+
+qreal NemoThumbnailLoader::memoryHitRate() const
+{
+    return m_statistics.memoryHitRate();
+}
+
+qreal NemoThumbnailLoader::diskHitRate() const
+{
+    return m_statistics.diskHitRate();
+}
+
+QVariantList NemoThumbnailLoader::loadQueueDepths() const
+{
+    QVariantList depths;
+    for (int depth : m_statistics.loadQueueDepth)
+        depths.append(depth);
+    return depths;
+}
+
+QVariantList NemoThumbnailLoader::generateQueueDepths() const
+{
+    QVariantList depths;
+    for (int depth : m_statistics.generateQueueDepth)
+        depths.append(depth);
+    return depths;
+}
+
+int NemoThumbnailLoader::totalCost() const
+{
+    return m_statistics.totalCost;
+}
+
+int NemoThumbnailLoader::peakCost() const
+{
+    return m_statistics.peakCost;
+}
+
+int NemoThumbnailLoader::wastedLoads() const
+{
+    return m_statistics.wastedLoads;
+}
+
+QVariantMap NemoThumbnailLoader::generations() const
+{
+    QVariantMap generations;
+    for (auto it = m_statistics.generations.cbegin(); it != m_statistics.generations.cend(); ++it)
+        generations.insert(it.key(), it.value());
+    return generations;
+}
+
+QVariantMap NemoThumbnailLoader::stageLatencies() const
+{
+    QVariantMap latencies;
+    for (int stage = 0; stage < NemoThumbnailTrace::StageCount; ++stage) {
+        QVariantMap latency;
+        latency.insert(QStringLiteral("p50"), m_statistics.stageP50[stage]);
+        latency.insert(QStringLiteral("p95"), m_statistics.stageP95[stage]);
+        latencies.insert(stage == NemoThumbnailTrace::Queued
+                    ? QStringLiteral("total")
+                    : QString::fromLatin1(NemoThumbnailTrace::stageName(NemoThumbnailTrace::Stage(stage))),
+                latency);
+    }
+    return latencies;
+}
+
+void NemoThumbnailLoader::collectLatencies()
+{
+    m_latenciesCollected = true;
+}
+
+void NemoThumbnailLoader::connectNotify(const QMetaMethod &signal)
+{
+    // Something is watching the statistics, time requests so stageLatencies is meaningful.
+    if (signal == QMetaMethod::fromSignal(&NemoThumbnailLoader::statisticsChanged))
+        m_latenciesCollected = true;
+    QThread::connectNotify(signal);
+}
+
+void NemoThumbnailLoader::finishTiming(ThumbnailRequest *request)
+{
+    // Only the first time a request is displayed is measured, showing it again from memory
+    // isn't interesting.
+    const qint64 * const trace = request->trace;
+    if (!trace)
+        return;
+
+    if (NemoThumbnailTrace::isEnabled())
+        NemoThumbnailTrace::finish(request->fileName, request->size, trace);
+
+    QMutexLocker locker(&m_mutex);
+
+    qint64 previous = trace[NemoThumbnailTrace::Queued];
+    for (int stage = NemoThumbnailTrace::Started; stage < NemoThumbnailTrace::StageCount; ++stage) {
+        qint32 latency = -1;
+        if (trace[stage] != 0) {
+            latency = (trace[stage] - previous) / 1000;
+            previous = trace[stage];
+        }
+        m_latencySamples[stage][m_latencySampleIndex] = latency;
+    }
+    m_latencySamples[NemoThumbnailTrace::Queued][m_latencySampleIndex]
+            = (previous - trace[NemoThumbnailTrace::Queued]) / 1000;
+
+    m_latencySampleIndex = (m_latencySampleIndex + 1) % LatencySampleCount;
+    m_latencySampleCount = qMin(m_latencySampleCount + 1, int(LatencySampleCount));
+    m_statisticsChanged = true;
+
+    delete [] request->trace;
+    request->trace = nullptr;
+}
+
+void NemoThumbnailLoader::updateStatistics()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_statisticsChanged = true;
+    }
+
+    // Changes are reported at most once an interval.  The timer runs for an interval after
+    // the last change so changes made by the loader and render threads in the meantime are
+    // reported too.
+    if (!m_statisticsTimer.isActive())
+        m_statisticsTimer.start(StatisticsInterval, this);
+}
+
+void NemoThumbnailLoader::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_statisticsTimer.timerId()) {
+        bool changed;
+        {
+            QMutexLocker locker(&m_mutex);
+            changed = m_statisticsChanged;
+            m_statisticsChanged = false;
+        }
+
+        if (changed) {
+            m_statistics = statistics();
+            emit statisticsChanged();
+        } else {
+            m_statisticsTimer.stop();
+        }
+    } else {
+        QThread::timerEvent(event);
+    }
+}
+
 void NemoThumbnailLoader::updateRequest(NemoThumbnailItem *item, bool identityChanged)
 {
     ThumbnailRequest *previousRequest = item->m_request;
@@ -433,53 +750,60 @@ void NemoThumbnailLoader::updateRequest(NemoThumbnailItem *item, bool identityCh
         const bool crop = item->m_fillMode == NemoThumbnailItem::PreserveAspectCrop;
 
         // Create an identifier for this request's data
-        const uint cacheKey = qHash(crop)
-                ^ qHash(item->m_sourceSize.width())
-                ^ qHash(item->m_sourceSize.height())
-                ^ qHash(fileName);
+        const ThumbnailRequestKey cacheKey = { fileName, item->m_sourceSize, item->m_stripFrames, crop };
 
         item->m_request = m_requestCache.value(cacheKey);
 
         if (!item->m_request) {
-            item->m_request = new ThumbnailRequest(item, fileName, cacheKey);
-            m_requestCache.insert(cacheKey, item->m_request);
+            item->m_request = new ThumbnailRequest(
+                        item, cacheKey, m_latenciesCollected || NemoThumbnailTrace::isEnabled());
+            m_requestCache.insert(item->m_request);
+            ++m_memoryMisses;
+        } else {
+            ++m_memoryHits;
         }
+        updateStatistics();
         item->m_request->items.append(item);
 
-        // If an existing request is already completed, push it to the back of the cached requests
-        // lists to renew it and update the item.
-        if (item->m_request->status == NemoThumbnailItem::Ready) {
-            m_cachedRequests.append(item->m_request);
+        // A completed request can't be released while an item shows it, whether it succeeded or
+        // failed.  A request showing a placeholder is still waiting for its thumbnail to be
+        // generated so it stays queued.
+        if (item->m_request->status != NemoThumbnailItem::Loading && !item->m_request->refining)
+            item->m_request->listNode.erase();
 
+        // If an existing request is already completed, update the item.
+        if (item->m_request->status == NemoThumbnailItem::Ready) {
+            const QSize implicitSize = frameSize(item->m_request, item->m_request->pixmap.size());
             item->m_imageChanged = true;
-            item->setImplicitWidth(item->m_request->pixmap.width());
-            item->setImplicitHeight(item->m_request->pixmap.height());
+            item->setImplicitWidth(implicitSize.width());
+            item->setImplicitHeight(implicitSize.height());
             emit item->statusChanged();
             item->update();
-            return;
         } else if (wasReady) {
             item->update();
         }
     }
 
-    // If the cache is full release excess unreferenced items.
-    ThumbnailRequestList::iterator it = m_cachedRequests.begin();
-    while (m_totalCost > m_maxCost && it != m_cachedRequests.end()) {
-        if (it->items.isEmpty()) {
-            ThumbnailRequest *cachedRequest = it;
-            it = m_cachedRequests.erase(it);
-            m_totalCost -= cachedRequest->cacheCost;
-            m_requestCache.remove(cachedRequest->cacheKey);
+    // If the cache is full release the least recently used unreferenced requests.
+    while (m_totalCost > m_maxCost) {
+        ThumbnailRequest *cachedRequest = m_cachedRequests.takeFirst();
+        if (!cachedRequest)
+            break;
 
-            if (cachedRequest == previousRequest) {
-                // Avoid dangling pointer if previous request is purged from cache
-                previousRequest = nullptr;
-            }
+        // Requests are taken off the list when an item attaches to them.
+        Q_ASSERT(cachedRequest->items.isEmpty());
+        if (!cachedRequest->items.isEmpty())
+            continue;
 
-            delete cachedRequest;
-        } else {
-            ++it;
+        m_totalCost -= cachedRequest->cacheCost;
+        m_requestCache.remove(cachedRequest);
+
+        if (cachedRequest == previousRequest) {
+            // Avoid dangling pointer if previous request is purged from cache
+            previousRequest = nullptr;
         }
+
+        delete cachedRequest;
     }
 
     QMutexLocker locker(&m_mutex);
@@ -515,8 +839,15 @@ void NemoThumbnailLoader::cancelRequest(NemoThumbnailItem *item)
 
 void NemoThumbnailLoader::prioritizeRequest(ThumbnailRequest *request)
 {
-    if (request->loaded)
+    if (request->loaded) {
+        // A completed request no longer shown by any item may be released once the cache is
+        // full.  Requests waiting to be delivered are added when they are delivered.
+        if (request->items.isEmpty()
+                && request->status != NemoThumbnailItem::Loading
+                && !request->refining)
+            m_cachedRequests.append(request);
         return;
+    }
 
     ThumbnailRequestList *lists[] = {
         &m_thumbnailHighPriority, &m_thumbnailNormalPriority, &m_thumbnailLowPriority
@@ -531,7 +862,8 @@ void NemoThumbnailLoader::prioritizeRequest(ThumbnailRequest *request)
         // which case let it complete as it will either just be cached or appended to the low
         // priority generate queue.
         if (!request->loading) {
-            m_requestCache.remove(request->cacheKey);
+            m_requestCache.remove(request);
+            m_totalCost -= request->cacheCost;
             delete request;
         }
     } else if (request->priority != priority) {
@@ -544,7 +876,7 @@ void NemoThumbnailLoader::prioritizeRequest(ThumbnailRequest *request)
 bool NemoThumbnailLoader::event(QEvent *event)
 {
     if (event->type() == QEvent::User) {
-        // Move items from the completedRequests list to cachedRequests.
+        // Deliver completed requests, unreferenced requests are added to cachedRequests.
         ThumbnailRequestList completedRequests;
         {
             QMutexLocker locker(&m_mutex);
@@ -552,24 +884,40 @@ bool NemoThumbnailLoader::event(QEvent *event)
         }
 
         while (ThumbnailRequest *request = completedRequests.takeFirst()) {
-            m_cachedRequests.append(request);
+            // The items which wanted the thumbnail went away while it was being loaded.
+            if (request->items.isEmpty()) {
+                m_cachedRequests.append(request);
+                ++m_wastedLoads;
+            }
+
+            if (request->trace) {
+                request->trace[NemoThumbnailTrace::Delivered] = NemoThumbnailTrace::timestamp();
+            }
+
+            // Replace the cost of any placeholder previously shown for the request.
+            m_totalCost -= request->cacheCost;
+            request->cacheCost = 0;
 
             // Update any items associated with the request.
-            const QSize implicitSize = request->image.size();
+            const QSize implicitSize = frameSize(request, request->image.size());
             if (!request->image.isNull()) {
                 request->pixmap = request->image;
                 request->image = QImage();
                 request->status = NemoThumbnailItem::Ready;
 
                 // Store the cache cost associated with request as pixmap may get freed
-                // if it is loaded into texture
-                request->cacheCost = implicitSize.width() * implicitSize.height();
+                // if it is loaded into texture.  The texture holds the whole image, every
+                // frame of a strip.
+                request->cacheCost = request->pixmap.width() * request->pixmap.height();
                 m_totalCost += request->cacheCost;
+                m_peakCost = qMax(m_peakCost, m_totalCost);
             } else {
                 request->pixmap = QImage();
                 request->image = QImage();
 
                 request->status = NemoThumbnailItem::Error;
+
+                finishTiming(request);
             }
             for (ThumbnailItemList::iterator item = request->items.begin();
                     item != request->items.end();
@@ -580,8 +928,22 @@ bool NemoThumbnailLoader::event(QEvent *event)
                 emit item->statusChanged();
                 item->update();
             }
+
+            request->refining = request->placeholder && request->status == NemoThumbnailItem::Ready;
+            if (request->refining) {
+                // Show the placeholder until the thumbnail at the requested size is generated.
+                QMutexLocker locker(&m_mutex);
+                ThumbnailRequestList *lists[] = {
+                    &m_generateHighPriority, &m_generateNormalPriority, &m_generateLowPriority
+                };
+                request->loaded = false;
+                lists[request->priority]->append(request);
+                m_waitCondition.wakeOne();
+            }
         }
 
+        updateStatistics();
+
         return true;
     } else {
         return QThread::event(event);
@@ -590,6 +952,9 @@ bool NemoThumbnailLoader::event(QEvent *event)
 
 void NemoThumbnailLoader::run()
 {
+    // Map the busy state before anything is loaded so marking it is only a store.
+    busyState();
+
     QMutexLocker locker(&m_mutex);
 
     for (;;) {
@@ -620,48 +985,155 @@ void NemoThumbnailLoader::run()
         }
 
         Q_ASSERT(request);
+
+        if (tryCache) {
+            loadCached(request, &locker);
+            continue;
+        }
+
         const QString fileName = request->fileName;
         const QString mimeType = request->mimeType;
         const QSize requestedSize = request->size;
+        const int stripFrames = request->stripFrames;
         const bool crop = request->fillMode == NemoThumbnailItem::PreserveAspectCrop;
+        qint64 * const trace = request->trace;
 
         request->loading = true;
 
         locker.unlock();
 
-        if (tryCache) {
-            NemoThumbnailCache::ThumbnailData thumbnail
-                    = NemoThumbnailCache::instance()->existingThumbnail(fileName, requestedSize, crop);
-            QImage image = thumbnail.getScaledImage(requestedSize, crop);
-
-            locker.relock();
-            request->loading = false;
-
-            if (!image.isNull()) {
-                request->loaded = true;
-                request->image = image;
-                if (m_completedRequests.isEmpty())
-                    QCoreApplication::postEvent(this, new QEvent(QEvent::User));
-                m_completedRequests.append(request);
-            } else {
-                ThumbnailRequestList *lists[] = {
-                    &m_generateHighPriority, &m_generateNormalPriority, &m_generateLowPriority
-                };
-                lists[request->priority]->append(request);
-            }
-        } else {
-            NemoThumbnailCache::ThumbnailData thumbnail
-                    = NemoThumbnailCache::instance()->requestThumbnail(fileName, requestedSize, crop, true, mimeType);
-            QImage image = thumbnail.getScaledImage(requestedSize, crop);
+        markBusy();
+
+        NemoThumbnailTrace::Scope traceScope(trace);
+        NemoThumbnailTrace::mark(NemoThumbnailTrace::Started);
+
+        QImage image;
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            const NemoThumbnailCache::ThumbnailData thumbnail = stripFrames > 0
+                    ? NemoThumbnailCache::instance()->requestStrip(fileName, stripFrames, requestedSize, mimeType)
+                    : NemoThumbnailCache::instance()->requestThumbnail(fileName, requestedSize, crop, true, mimeType);
+            image = stripFrames > 0
+                    ? thumbnail.getImage()
+                    : thumbnail.getScaledImage(requestedSize, crop);
+
+            // An entry which exists but can't be loaded would be found again every time, whether
+            // here or by loadCached() which only checks entries exist.  Remove it and generate
+            // a replacement.
+            if (!image.isNull() || !thumbnail.validPath() || !QFile::remove(thumbnail.path()))
+                break;
+        }
+
+        locker.relock();
+        ++m_generations[mimeType.isEmpty() ? QStringLiteral("unknown") : mimeType];
+        m_statisticsChanged = true;
+
+        request->loading = false;
+        request->loaded = true;
+        request->placeholder = false;
+        request->image = image;
+        if (m_completedRequests.isEmpty())
+            QCoreApplication::postEvent(this, new QEvent(QEvent::User));
+        m_completedRequests.append(request);
+    }
+}
 
-            locker.relock();
-            request->loading = false;
+// Loads a request from the cache together with the others waiting at the same priority, so the
+// cache entries of a screenful of thumbnails are looked up at once.  Called and returns with
+// m_mutex locked.
+void NemoThumbnailLoader::loadCached(ThumbnailRequest *first, QMutexLocker *locker)
+{
+    const int batchPriority = first->priority;
+
+    ThumbnailRequestList *lists[] = {
+        &m_thumbnailHighPriority, &m_thumbnailNormalPriority, &m_thumbnailLowPriority
+    };
+    ThumbnailRequestList *generateLists[] = {
+        &m_generateHighPriority, &m_generateNormalPriority, &m_generateLowPriority
+    };
+
+    QVector<ThumbnailRequest *> batch;
+    QVector<qint64 *> traces;
+    QVector<NemoThumbnailCache::Probe> probes;
+    for (ThumbnailRequest *request = first; request; ) {
+        request->loading = true;
+
+        NemoThumbnailCache::Probe probe;
+        probe.path = request->fileName;
+        probe.requestedSize = request->size;
+        probe.crop = request->fillMode == NemoThumbnailItem::PreserveAspectCrop;
+        probe.frames = request->stripFrames;
+
+        batch.append(request);
+        traces.append(request->trace);
+        probes.append(probe);
+
+        request = batch.count() < MaximumProbeBatch ? lists[batchPriority]->takeFirst() : 0;
+    }
+
+    locker->unlock();
+
+    markBusy();
+
+    for (qint64 *trace : traces) {
+        NemoThumbnailTrace::Scope traceScope(trace);
+        NemoThumbnailTrace::mark(NemoThumbnailTrace::Started);
+    }
+
+    const QVector<NemoThumbnailCache::ThumbnailData> thumbnails
+            = NemoThumbnailCache::instance()->existingThumbnails(probes);
+
+    for (int i = 0; i < batch.count(); ++i) {
+        ThumbnailRequest * const request = batch.at(i);
+        const NemoThumbnailCache::Probe &probe = probes.at(i);
+        const NemoThumbnailCache::ThumbnailData &thumbnail = thumbnails.at(i);
+
+        NemoThumbnailTrace::Scope traceScope(traces.at(i));
+        NemoThumbnailTrace::mark(NemoThumbnailTrace::Probed);
+
+        QImage image = probe.frames > 0
+                ? thumbnail.getImage()
+                : thumbnail.getScaledImage(probe.requestedSize, probe.crop);
+
+        locker->relock();
+        request->loading = false;
+
+        if (!image.isNull() && !thumbnail.placeholder())
+            ++m_diskHits;
+        else
+            ++m_diskMisses;
+        m_statisticsChanged = true;
+
+        // If a placeholder is already being shown don't load another, generate the thumbnail.
+        // An entry which was found but couldn't be loaded is a miss and is replaced when the
+        // request is generated.
+        if (!image.isNull() && !(thumbnail.placeholder() && request->placeholder)) {
             request->loaded = true;
+            request->placeholder = thumbnail.placeholder();
             request->image = image;
             if (m_completedRequests.isEmpty())
                 QCoreApplication::postEvent(this, new QEvent(QEvent::User));
             m_completedRequests.append(request);
+        } else {
+            generateLists[request->priority]->append(request);
+        }
+
+        // Don't hold up more urgent requests or quitting while the rest of the batch is decoded,
+        // return the remainder to the front of their queues.
+        bool preempted = m_quit || m_suspend;
+        for (int priority = 0; priority < batchPriority && !preempted; ++priority) {
+            preempted = !lists[priority]->isEmpty()
+                    || (batchPriority == NemoThumbnailItem::LowPriority && !generateLists[priority]->isEmpty());
         }
+        if (preempted) {
+            for (int j = batch.count() - 1; j > i; --j) {
+                batch.at(j)->loading = false;
+                lists[batch.at(j)->priority]->prepend(batch.at(j));
+            }
+            return;
+        }
+
+        if (i + 1 < batch.count())
+            locker->unlock();
     }
 }
 
@@ -705,8 +1177,9 @@ void NemoThumbnailLoader::destroyTextures()
             }
         }
 
-        ThumbnailRequestList cachedRequests = m_cachedRequests;
-        while (ThumbnailRequest *request = cachedRequests.takeFirst()) {
+        // Any texture remaining belongs to a completed request, whether or not it is shown by
+        // an item.
+        foreach (ThumbnailRequest *request, m_requestCache.requests()) {
             if (request->texture) {
                 for (ThumbnailItemList::iterator item = request->items.begin();
                             item != request->items.end();
@@ -718,8 +1191,6 @@ void NemoThumbnailLoader::destroyTextures()
                 request->loaded = false;
                 request->status = NemoThumbnailItem::Loading;
                 lists[request->priority]->append(request);
-            } else {
-                m_cachedRequests.append(request);
             }
         }
     }
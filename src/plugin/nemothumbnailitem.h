@@ -39,8 +39,13 @@
 #include <QQuickItem>
 #include <QSGTexture>
 #include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVariant>
 
 #include "linkedlist.h"
+#include "nemothumbnailrequestcache.h"
+#include "nemothumbnailtrace_p.h"
 
 struct ThumbnailRequest;
 
@@ -54,6 +59,8 @@ class NemoThumbnailItem : public QQuickItem
     Q_PROPERTY(FillMode fillMode READ fillMode WRITE setFillMode NOTIFY fillModeChanged)
     Q_PROPERTY(Priority priority READ priority WRITE setPriority NOTIFY priorityChanged)
     Q_PROPERTY(Status status READ status NOTIFY statusChanged)
+    Q_PROPERTY(int stripFrames READ stripFrames WRITE setStripFrames NOTIFY stripFramesChanged)
+    Q_PROPERTY(int frame READ frame WRITE setFrame NOTIFY frameChanged)
     Q_ENUMS(Priority)
     Q_ENUMS(Status)
     Q_ENUMS(FillMode)
@@ -103,6 +110,12 @@ public:
 
     Status status() const;
 
+    int stripFrames() const;
+    void setStripFrames(int frames);
+
+    int frame() const;
+    void setFrame(int frame);
+
     QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *);
     void itemChange(ItemChange, const ItemChangeData &);
 
@@ -117,6 +130,8 @@ Q_SIGNALS:
     void fillModeChanged();
     void priorityChanged();
     void statusChanged();
+    void stripFramesChanged();
+    void frameChanged();
 
 private:
     Q_DISABLE_COPY(NemoThumbnailItem)
@@ -132,6 +147,8 @@ private:
     QSize m_sourceSize;
     Priority m_priority;
     FillMode m_fillMode;
+    int m_stripFrames;
+    int m_frame;
     bool m_imageChanged;
     QBasicTimer delayLoaderCreationTimer;
 
@@ -146,15 +163,16 @@ typedef LinkedList<NemoThumbnailItem, &NemoThumbnailItem::listNode> ThumbnailIte
 
 struct ThumbnailRequest
 {
-    ThumbnailRequest(NemoThumbnailItem *item, const QString &fileName, uint cacheKey);
+    ThumbnailRequest(NemoThumbnailItem *item, const ThumbnailRequestKey &cacheKey, bool timed);
     ~ThumbnailRequest();
 
     LinkedListNode listNode;
     ThumbnailItemList items;
-    uint cacheKey;
+    ThumbnailRequestKey cacheKey;
     QString fileName;
     QString mimeType;
     QSize size;
+    int stripFrames;
     QImage image;
     QImage pixmap;
     QSGTexture *texture;
@@ -163,7 +181,12 @@ struct ThumbnailRequest
     NemoThumbnailItem::Priority priority;
     bool loading;
     bool loaded;
+    bool placeholder;
+    bool refining;
     uint cacheCost;
+    // Stage timestamps of a timed request, released once it has been displayed for the first
+    // time.
+    qint64 *trace;
 };
 
 typedef LinkedList<ThumbnailRequest, &ThumbnailRequest::listNode> ThumbnailRequestList;
@@ -172,7 +195,40 @@ class NemoThumbnailLoader : public QThread
 {
     Q_OBJECT
     Q_PROPERTY(int maxCost READ maxCost WRITE setMaxCost NOTIFY maxCostChanged)
+    Q_PROPERTY(qreal memoryHitRate READ memoryHitRate NOTIFY statisticsChanged)
+    Q_PROPERTY(qreal diskHitRate READ diskHitRate NOTIFY statisticsChanged)
+    Q_PROPERTY(QVariantList loadQueueDepths READ loadQueueDepths NOTIFY statisticsChanged)
+    Q_PROPERTY(QVariantList generateQueueDepths READ generateQueueDepths NOTIFY statisticsChanged)
+    Q_PROPERTY(int totalCost READ totalCost NOTIFY statisticsChanged)
+    Q_PROPERTY(int peakCost READ peakCost NOTIFY statisticsChanged)
+    Q_PROPERTY(int wastedLoads READ wastedLoads NOTIFY statisticsChanged)
+    Q_PROPERTY(QVariantMap generations READ generations NOTIFY statisticsChanged)
+    Q_PROPERTY(QVariantMap stageLatencies READ stageLatencies NOTIFY statisticsChanged)
 public:
+    struct Statistics
+    {
+        // Items which shared the request of another item for the same thumbnail or didn't.
+        int memoryHits = 0;
+        int memoryMisses = 0;
+        // Cache lookups which found or didn't find a thumbnail of the requested size.
+        int diskHits = 0;
+        int diskMisses = 0;
+        int loadQueueDepth[NemoThumbnailItem::PriorityCount] = {};
+        int generateQueueDepth[NemoThumbnailItem::PriorityCount] = {};
+        int totalCost = 0;
+        int peakCost = 0;
+        // Thumbnails which finished loading after every item showing them was destroyed.
+        int wastedLoads = 0;
+        QHash<QString, int> generations;
+        // Milliseconds taken to reach each stage from the one before it over recent requests, the
+        // Queued entry holds the time taken from being queued to being displayed.
+        qreal stageP50[NemoThumbnailTrace::StageCount] = {};
+        qreal stageP95[NemoThumbnailTrace::StageCount] = {};
+
+        qreal memoryHitRate() const;
+        qreal diskHitRate() const;
+    };
+
     explicit NemoThumbnailLoader(QQuickWindow *window);
     ~NemoThumbnailLoader();
 
@@ -185,16 +241,42 @@ public:
     int maxCost() const;
     void setMaxCost(int cost);
 
+    Statistics statistics();
+
+    qreal memoryHitRate() const;
+    qreal diskHitRate() const;
+    QVariantList loadQueueDepths() const;
+    QVariantList generateQueueDepths() const;
+    int totalCost() const;
+    int peakCost() const;
+    int wastedLoads() const;
+    QVariantMap generations() const;
+    QVariantMap stageLatencies() const;
+
+    // Times the stages of requests created from now on.  Requests are otherwise only timed while
+    // tracing is enabled or statisticsChanged is connected.
+    void collectLatencies();
+    void finishTiming(ThumbnailRequest *request);
+
 signals:
     void maxCostChanged();
+    void statisticsChanged();
 
 protected:
     bool event(QEvent *event);
+    void timerEvent(QTimerEvent *event);
     void run();
+    void connectNotify(const QMetaMethod &signal) override;
 
 private:
+    enum {
+        LatencySampleCount = 256
+    };
+
+    void loadCached(ThumbnailRequest *first, QMutexLocker *locker);
     void restartLoader();
     void destroyTextures();
+    void updateStatistics();
 
     ThumbnailRequestList m_thumbnailHighPriority;
     ThumbnailRequestList m_thumbnailNormalPriority;
@@ -203,8 +285,26 @@ private:
     ThumbnailRequestList m_generateNormalPriority;
     ThumbnailRequestList m_generateLowPriority;
     ThumbnailRequestList m_completedRequests;
+    // Completed requests which aren't shown by any item, least recently used first.
     ThumbnailRequestList m_cachedRequests;
-    QHash<uint, ThumbnailRequest *> m_requestCache;
+    ThumbnailRequestCache m_requestCache;
+
+    // Guarded by m_mutex.
+    QHash<QString, int> m_generations;
+    qint32 m_latencySamples[NemoThumbnailTrace::StageCount][LatencySampleCount];
+    int m_latencySampleIndex;
+    int m_latencySampleCount;
+    int m_diskHits;
+    int m_diskMisses;
+    bool m_statisticsChanged;
+
+    Statistics m_statistics;
+    QBasicTimer m_statisticsTimer;
+    bool m_latenciesCollected;
+    int m_memoryHits;
+    int m_memoryMisses;
+    int m_peakCost;
+    int m_wastedLoads;
 
     QMutex m_mutex;
     QWaitCondition m_waitCondition;
@@ -36,27 +36,166 @@
 #include <QFile>
 #include <QImage>
 #include <QDebug>
+#include <QUrlQuery>
 
-QImage NemoThumbnailProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+namespace {
+
+int providerThreadCount()
+{
+    const QByteArray threadsEnv = qgetenv("NEMO_THUMBNAILER_PROVIDER_THREADS");
+
+    bool ok = false;
+    int threads = threadsEnv.toInt(&ok);
+    return ok && threads > 0 ? threads : 2;
+}
+
+// Splits an id of the form "<path>[?fillMode=fit|crop]" into the path and the fill mode.
+QString parseId(const QString &id, bool *crop)
 {
+    *crop = true;
+
+    const int queryIndex = id.lastIndexOf(QLatin1Char('?'));
+    if (queryIndex == -1) {
+        return id;
+    }
+
+    const QUrlQuery query(id.mid(queryIndex + 1));
+    if (!query.hasQueryItem(QStringLiteral("fillMode"))) {
+        // Not one of ours, the question mark is part of the file name.
+        return id;
+    }
+
+    const QString fillMode = query.queryItemValue(QStringLiteral("fillMode"));
+    if (fillMode == QLatin1String("fit")) {
+        *crop = false;
+    } else if (fillMode != QLatin1String("crop")) {
+        qWarning() << "Unknown nemoThumbnail fillMode" << fillMode << "using crop";
+    }
+    return id.left(queryIndex);
+}
+
+}
+
+NemoThumbnailResponse::NemoThumbnailResponse(NemoThumbnailProvider *provider, const QString &id, const QSize &requestedSize)
+    : m_provider(provider)
+    , m_id(id)
+    , m_requestedSize(requestedSize)
+{
+    // The engine owns the response and deletes it after finished() is emitted.
+    setAutoDelete(false);
+}
+
+QQuickTextureFactory *NemoThumbnailResponse::textureFactory() const
+{
+    return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
+
+QString NemoThumbnailResponse::errorString() const
+{
+    return m_errorString;
+}
+
+void NemoThumbnailResponse::cancel()
+{
+    if (m_finished.loadAcquire()) {
+        return;
+    }
+
+    m_cancelled.storeRelease(1);
+
+    // A response which hasn't started yet can be finished straight away, a running one will
+    // notice the flag between stages.
+    if (m_provider->takeQueued(this)) {
+        finish();
+    }
+}
+
+void NemoThumbnailResponse::finish()
+{
+    m_finished.storeRelease(1);
+    emit finished();
+}
+
+void NemoThumbnailResponse::run()
+{
+    m_provider->started(this);
+
     // sourceSize should indicate what size thumbnail you want. i.e. if you want a 120x120px thumbnail,
     // set sourceSize: Qt.size(120, 120).
-    if (!requestedSize.isValid()) {
-        qWarning("You must request a sourceSize whenever you use nemoThumbnail");
-        return QImage();
+    if (!m_requestedSize.isValid()) {
+        m_errorString = QStringLiteral("You must request a sourceSize whenever you use nemoThumbnail");
+        qWarning("%s", qPrintable(m_errorString));
+        finish();
+        return;
     }
 
-    if (size)
-        *size = requestedSize;
+    bool crop = true;
+    const QString path = parseId(m_id, &crop);
+
+    NemoThumbnailCache *cache = NemoThumbnailCache::instance();
+
+    NemoThumbnailCache::ThumbnailData thumbnail;
+    if (!m_cancelled.loadAcquire()) {
+        thumbnail = cache->requestThumbnail(path, m_requestedSize, crop);
+    }
+
+    if (!m_cancelled.loadAcquire()) {
+        // Read the cached thumbnail at the requested size instead of decoding it at full size.
+        m_image = thumbnail.getScaledImage(m_requestedSize, crop);
+        if (m_image.isNull()) {
+            m_errorString = QStringLiteral("Unable to load thumbnail for ") + path;
+        }
+    }
+
+    finish();
+}
+
+NemoThumbnailProvider::NemoThumbnailProvider()
+{
+    m_pool.setMaxThreadCount(providerThreadCount());
+}
 
-    NemoThumbnailCache::ThumbnailData thumbnail = NemoThumbnailCache::instance()->requestThumbnail(id, requestedSize, true);
-    if (thumbnail.validImage()) {
-        return thumbnail.image();
+NemoThumbnailProvider::~NemoThumbnailProvider()
+{
+    // Finish the responses which never started so the images waiting for them don't stay
+    // loading, then wait for the running ones.
+    QList<NemoThumbnailResponse *> cancelled;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (NemoThumbnailResponse *response : m_queued) {
+            if (m_pool.tryTake(response)) {
+                cancelled.append(response);
+            }
+        }
+        m_queued.clear();
     }
-    if (thumbnail.validPath()) {
-        return QImage(thumbnail.path());
+
+    for (NemoThumbnailResponse *response : cancelled) {
+        response->m_errorString = QStringLiteral("The nemoThumbnail provider was destroyed");
+        response->finish();
     }
 
-    return QImage();
+    m_pool.waitForDone();
+}
+
+QQuickImageResponse *NemoThumbnailProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    NemoThumbnailResponse *response = new NemoThumbnailResponse(this, id, requestedSize);
+
+    QMutexLocker locker(&m_mutex);
+    m_queued.insert(response);
+    m_pool.start(response);
+    return response;
 }
 
+bool NemoThumbnailProvider::takeQueued(NemoThumbnailResponse *response)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_queued.remove(response) && m_pool.tryTake(response);
+}
+
+void NemoThumbnailProvider::started(NemoThumbnailResponse *response)
+{
+    QMutexLocker locker(&m_mutex);
+    m_queued.remove(response);
+}
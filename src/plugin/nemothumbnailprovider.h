@@ -32,17 +32,59 @@
 #ifndef NEMOTHUMBNAILPROVIDER_H
 #define NEMOTHUMBNAILPROVIDER_H
 
+#include <QAtomicInt>
+#include <QMutex>
 #include <QQuickImageProvider>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
 
-class NemoThumbnailProvider : public QQuickImageProvider
+class NemoThumbnailProvider;
+
+class NemoThumbnailResponse : public QQuickImageResponse, public QRunnable
 {
 public:
-    NemoThumbnailProvider()
-        : QQuickImageProvider(QQuickImageProvider::Image)
-    {
-    }
+    NemoThumbnailResponse(NemoThumbnailProvider *provider, const QString &id, const QSize &requestedSize);
+
+    QQuickTextureFactory *textureFactory() const override;
+    QString errorString() const override;
+
+    void cancel() override;
+    void run() override;
+
+private:
+    friend class NemoThumbnailProvider;
+
+    void finish();
+
+    NemoThumbnailProvider * const m_provider;
+    const QString m_id;
+    const QSize m_requestedSize;
+    QImage m_image;
+    QString m_errorString;
+    QAtomicInt m_cancelled;
+    // Set once finished() has been emitted, after which the provider may no longer exist.
+    QAtomicInt m_finished;
+};
+
+class NemoThumbnailProvider : public QQuickAsyncImageProvider
+{
+public:
+    NemoThumbnailProvider();
+    ~NemoThumbnailProvider();
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+private:
+    friend class NemoThumbnailResponse;
+
+    bool takeQueued(NemoThumbnailResponse *response);
+    void started(NemoThumbnailResponse *response);
 
-    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+    QThreadPool m_pool;
+    QMutex m_mutex;
+    // Responses which haven't started running, guarded by m_mutex.
+    QSet<NemoThumbnailResponse *> m_queued;
 };
 
 #endif // NEMOTHUMBNAILPROVIDER_H
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "nemothumbnailrecorder.h"
+#include "nemothumbnailitem.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+
+namespace {
+
+class TraceRecording
+{
+public:
+    TraceRecording()
+        : file(QFile::decodeName(qgetenv("NEMO_THUMBNAILER_RECORD")))
+    {
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            file.write("# nemo-thumbnailer scroll trace 1\n");
+            timer.start();
+        } else {
+            qWarning() << "Cannot record thumbnail trace to" << file.fileName() << file.errorString();
+        }
+    }
+
+    void write(const char *event, const NemoThumbnailItem *item)
+    {
+        if (!file.isOpen())
+            return;
+
+        const QByteArray mimeType = item->mimeType().toUtf8();
+
+        QByteArray line = QByteArray::number(timer.elapsed())
+                + ' ' + event
+                + ' ' + QByteArray::number(quintptr(item), 16);
+        if (qstrcmp(event, "destroy") != 0) {
+            line += ' ' + QByteArray::number(item->priority())
+                    + ' ' + QByteArray::number(item->fillMode())
+                    + ' ' + QByteArray::number(item->sourceSize().width())
+                    + ' ' + QByteArray::number(item->sourceSize().height())
+                    + ' ' + (item->source().isEmpty() ? QByteArray("-") : item->source().toEncoded())
+                    + ' ' + (mimeType.isEmpty() ? QByteArray("-") : mimeType);
+        }
+        line += '\n';
+
+        file.write(line);
+        file.flush();
+    }
+
+private:
+    QFile file;
+    QElapsedTimer timer;
+};
+
+Q_GLOBAL_STATIC(TraceRecording, recording)
+
+}
+
+bool NemoThumbnailRecorder::isEnabled()
+{
+    static const bool enabled = !qgetenv("NEMO_THUMBNAILER_RECORD").isEmpty();
+    return enabled;
+}
+
+void NemoThumbnailRecorder::itemCreated(NemoThumbnailItem *item)
+{
+    recording->write("create", item);
+
+    const auto changed = [item]() { recording->write("change", item); };
+    QObject::connect(item, &NemoThumbnailItem::sourceChanged, item, changed);
+    QObject::connect(item, &NemoThumbnailItem::mimeTypeChanged, item, changed);
+    QObject::connect(item, &NemoThumbnailItem::sourceSizeChanged, item, changed);
+    QObject::connect(item, &NemoThumbnailItem::fillModeChanged, item, changed);
+    QObject::connect(item, &NemoThumbnailItem::priorityChanged, item, changed);
+}
+
+void NemoThumbnailRecorder::itemDestroyed(NemoThumbnailItem *item)
+{
+    recording->write("destroy", item);
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include "nemothumbnailrequestcache.h"
+
+#include "nemothumbnailitem.h"
+
+uint qHash(const ThumbnailRequestKey &key, uint seed)
+{
+    // The fields are combined in order so transposed sizes don't collide, as they would if the
+    // hashes were combined with XOR.
+    uint hash = qHash(key.fileName, seed);
+    hash = hash * 31 + uint(key.size.width());
+    hash = hash * 31 + uint(key.size.height());
+    hash = hash * 31 + uint(key.stripFrames);
+    return hash * 2 + (key.crop ? 1 : 0);
+}
+
+ThumbnailRequest *ThumbnailRequestCache::value(const ThumbnailRequestKey &key) const
+{
+    const Shard &shard = this->shard(key);
+    QMutexLocker locker(&shard.mutex);
+    return shard.requests.value(key);
+}
+
+void ThumbnailRequestCache::insert(ThumbnailRequest *request)
+{
+    Shard &shard = this->shard(request->cacheKey);
+    QMutexLocker locker(&shard.mutex);
+    shard.requests.insert(request->cacheKey, request);
+}
+
+void ThumbnailRequestCache::remove(ThumbnailRequest *request)
+{
+    Shard &shard = this->shard(request->cacheKey);
+    QMutexLocker locker(&shard.mutex);
+    shard.requests.remove(request->cacheKey);
+}
+
+QVector<ThumbnailRequest *> ThumbnailRequestCache::requests() const
+{
+    QVector<ThumbnailRequest *> requests;
+    for (const Shard &shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        for (ThumbnailRequest *request : shard.requests)
+            requests.append(request);
+    }
+    return requests;
+}
+
+const ThumbnailRequestCache::Shard &ThumbnailRequestCache::shard(const ThumbnailRequestKey &key) const
+{
+    // QHash buckets are selected by the low bits of the hash, use the high bits for the shard.
+    return m_shards[(qHash(key) >> 24) % ShardCount];
+}
+
+ThumbnailRequestCache::Shard &ThumbnailRequestCache::shard(const ThumbnailRequestKey &key)
+{
+    return m_shards[(qHash(key) >> 24) % ShardCount];
+}
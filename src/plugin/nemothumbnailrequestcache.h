@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#ifndef NEMOTHUMBNAILREQUESTCACHE_H
+#define NEMOTHUMBNAILREQUESTCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+struct ThumbnailRequest;
+
+// The properties of an item which identify the thumbnail it shows, items with equal keys share
+// a request.
+struct ThumbnailRequestKey
+{
+    QString fileName;
+    QSize size;
+    int stripFrames;
+    bool crop;
+
+    bool operator ==(const ThumbnailRequestKey &other) const
+    {
+        return fileName == other.fileName
+                && size == other.size
+                && stripFrames == other.stripFrames
+                && crop == other.crop;
+    }
+};
+
+uint qHash(const ThumbnailRequestKey &key, uint seed = 0);
+
+// Maps keys to the requests for them.  The map is split into shards each with its own lock so
+// requests can be looked up from several threads without contending.
+class ThumbnailRequestCache
+{
+public:
+    ThumbnailRequest *value(const ThumbnailRequestKey &key) const;
+    void insert(ThumbnailRequest *request);
+    void remove(ThumbnailRequest *request);
+
+    QVector<ThumbnailRequest *> requests() const;
+
+private:
+    enum {
+        ShardCount = 16
+    };
+
+    struct Shard
+    {
+        mutable QMutex mutex;
+        QHash<ThumbnailRequestKey, ThumbnailRequest *> requests;
+    };
+
+    const Shard &shard(const ThumbnailRequestKey &key) const;
+    Shard &shard(const ThumbnailRequestKey &key);
+
+    Shard m_shards[ShardCount];
+};
+
+#endif
@@ -6,7 +6,7 @@ CONFIG += qt plugin hide_symbols c++17 link_pkgconfig
 QT += qml quick
 
 INCLUDEPATH += ../lib
-LIBS += -L../lib -lnemothumbnailer-qt$${QT_MAJOR_VERSION}
+LIBS += -L../lib -lnemothumbnailer-qt$${QT_MAJOR_VERSION} -lrt
 
 target.path = $$[QT_INSTALL_QML]/$$PLUGIN_IMPORT_PATH
 INSTALLS += target
@@ -20,6 +20,10 @@ QMAKE_EXTRA_TARGETS += qmltypes
 
 SOURCES += plugin.cpp \
            nemothumbnailprovider.cpp \
-           nemothumbnailitem.cpp
+           nemothumbnailitem.cpp \
+           nemothumbnailrecorder.cpp \
+           nemothumbnailrequestcache.cpp
 HEADERS += nemothumbnailprovider.h \
-           nemothumbnailitem.h
+           nemothumbnailitem.h \
+           nemothumbnailrecorder.h \
+           nemothumbnailrequestcache.h
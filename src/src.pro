@@ -1,4 +1,8 @@
 TEMPLATE = subdirs
-SUBDIRS = lib plugin
+SUBDIRS = lib plugin daemon indexer warm maintenance imageformats
 lib.target = lib-target
 plugin.depends = lib-target
+daemon.depends = lib-target
+indexer.depends = lib-target
+warm.depends = lib-target
+maintenance.depends = lib-target
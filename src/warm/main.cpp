@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QThread>
+
+#include <signal.h>
+
+#include "nemothumbnailwarmer.h"
+
+namespace {
+
+QAtomicInt interrupted;
+
+void interrupt(int)
+{
+    interrupted.store(1);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    // Generate in this process so every core can be used.
+    qputenv("NEMO_THUMBNAILER_DAEMON", "0");
+
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+                "Generates thumbnails for the images and videos in a set of directories."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(
+                QStringLiteral("directories"), QStringLiteral("Directories to generate thumbnails for."),
+                QStringLiteral("directory..."));
+
+    const QCommandLineOption sizesOption(QStringLiteral("sizes"),
+                QStringLiteral("Comma separated thumbnail sizes to generate."),
+                QStringLiteral("sizes"), QStringLiteral("256,512"));
+    const QCommandLineOption fitOption(QStringLiteral("fit"),
+                QStringLiteral("Generate thumbnails fitting the size rather than cropped to it."));
+    const QCommandLineOption jobsOption(QStringLiteral("jobs"),
+                QStringLiteral("Thumbnails to generate at once."),
+                QStringLiteral("count"), QString::number(QThread::idealThreadCount()));
+    const QCommandLineOption memoryOption(QStringLiteral("memory"),
+                QStringLiteral("Memory budget for decoding sources."),
+                QStringLiteral("MiB"), QStringLiteral("256"));
+    parser.addOptions({ sizesOption, fitOption, jobsOption, memoryOption });
+    parser.process(app);
+
+    const QStringList directories = parser.positionalArguments();
+    if (directories.isEmpty()) {
+        parser.showHelp(EXIT_FAILURE);
+    }
+
+    QVector<QSize> sizes;
+    for (const QString &size : parser.value(sizesOption).split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        const int value = size.trimmed().toInt();
+        if (value > 0) {
+            sizes.append(QSize(value, value));
+        }
+    }
+    if (sizes.isEmpty()) {
+        QTextStream(stderr) << "No valid thumbnail sizes" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Stop dispatching and let the thumbnails in progress be written, so an interrupted run
+    // leaves a consistent cache and a later run continues where this one stopped.
+    struct sigaction action = {};
+    action.sa_handler = interrupt;
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+
+    NemoThumbnailWarmer warmer(directories, sizes, !parser.isSet(fitOption));
+    warmer.setThreadCount(qMax(1, parser.value(jobsOption).toInt()));
+    warmer.setMemoryBudget(parser.value(memoryOption).toInt());
+
+    const NemoThumbnailWarmer::Statistics statistics = warmer.run(interrupted);
+
+    const qreal seconds = qMax<qint64>(1, statistics.elapsed) / 1000.0;
+    QTextStream(stdout) << (interrupted.load() ? "Interrupted after " : "Finished in ")
+                        << QString::number(seconds, 'f', 1) << " s: "
+                        << statistics.sources << " sources, "
+                        << statistics.generated << " thumbnails generated, "
+                        << statistics.skipped << " already cached, "
+                        << statistics.failed << " failed, "
+                        << QString::number(statistics.generated / seconds, 'f', 1) << " thumbnails/s, "
+                        << QString::number(statistics.bytesRead / seconds / (1 << 20), 'f', 1) << " MiB/s"
+                        << endl;
+
+    return interrupted.load() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
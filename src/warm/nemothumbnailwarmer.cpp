@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include "nemothumbnailwarmer.h"
+
+#include <nemothumbnailcache.h>
+
+#include <QDateTime>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMimeDatabase>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace {
+
+const int ProgressInterval = 2000;
+const int DispatchPollInterval = 100;
+
+// Videos are decoded by an external process so their memory use isn't known up front.
+const int VideoCost = 16;
+
+// Exposes the protected wait so tasks can hold on to their budget until their thumbnails
+// have been written.
+class WarmerCache : public NemoThumbnailCache
+{
+public:
+    using NemoThumbnailCache::waitForCacheFile;
+};
+
+}
+
+class NemoThumbnailWarmer::Task : public QRunnable
+{
+public:
+    Task(NemoThumbnailWarmer *warmer, const Source &source, const QVector<QSize> &sizes, int cost)
+        : m_warmer(warmer)
+        , m_source(source)
+        , m_sizes(sizes)
+        , m_cost(cost)
+    {
+    }
+
+    void run() override
+    {
+        NemoThumbnailCache * const cache = NemoThumbnailCache::instance();
+        for (const QSize &size : m_sizes) {
+            const NemoThumbnailCache::ThumbnailData thumbnail = cache->requestThumbnail(
+                        m_source.path, size, m_warmer->m_crop, true, m_source.mimeType);
+
+            // Thumbnails the writer couldn't keep up with are only held in memory and have no
+            // path, those count as failures as they won't be in the cache later.
+            if (thumbnail.validPath() && WarmerCache::waitForCacheFile(thumbnail.path())) {
+                m_warmer->m_generated.ref();
+            } else {
+                m_warmer->m_failed.ref();
+            }
+        }
+
+        m_warmer->m_budget.release(m_cost);
+    }
+
+private:
+    NemoThumbnailWarmer * const m_warmer;
+    const Source m_source;
+    const QVector<QSize> m_sizes;
+    const int m_cost;
+};
+
+NemoThumbnailWarmer::NemoThumbnailWarmer(
+        const QStringList &directories, const QVector<QSize> &sizes, bool crop)
+    : m_directories(directories)
+    , m_sizes(sizes)
+    , m_memoryBudget(0)
+    , m_crop(crop)
+{
+    setMemoryBudget(256);
+}
+
+void NemoThumbnailWarmer::setThreadCount(int count)
+{
+    m_pool.setMaxThreadCount(count);
+}
+
+void NemoThumbnailWarmer::setMemoryBudget(int megabytes)
+{
+    megabytes = qMax(1, megabytes);
+    if (megabytes > m_memoryBudget) {
+        m_budget.release(megabytes - m_memoryBudget);
+    } else {
+        m_budget.acquire(m_memoryBudget - megabytes);
+    }
+    m_memoryBudget = megabytes;
+}
+
+NemoThumbnailWarmer::Statistics NemoThumbnailWarmer::run(const QAtomicInt &interrupted)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QElapsedTimer progressTimer;
+    progressTimer.start();
+
+    NemoThumbnailCache * const cache = NemoThumbnailCache::instance();
+
+    Statistics statistics;
+
+    const QVector<Source> sources = collectSources();
+    for (const Source &source : sources) {
+        if (interrupted.load()) {
+            break;
+        }
+
+        QVector<QSize> sizes;
+        for (const QSize &size : m_sizes) {
+            const NemoThumbnailCache::ThumbnailData existing = cache->existingThumbnail(source.path, size, m_crop);
+            if ((existing.validPath() || existing.validImage()) && !existing.placeholder()) {
+                ++statistics.skipped;
+            } else {
+                sizes.append(size);
+            }
+        }
+
+        ++statistics.sources;
+        if (sizes.isEmpty()) {
+            continue;
+        }
+
+        // The decoded source is the largest allocation by far, a budget larger than a source
+        // can hold is clamped so it still gets generated on its own.
+        int cost = VideoCost;
+        if (!source.mimeType.startsWith(QLatin1String("video/"))) {
+            const QSize size = QImageReader(source.path).size();
+            cost = size.isValid()
+                    ? int((qint64(size.width()) * size.height() * 4 + (1 << 20) - 1) >> 20)
+                    : 1;
+        }
+        cost = qBound(1, cost, m_memoryBudget);
+
+        while (!m_budget.tryAcquire(cost, DispatchPollInterval)) {
+            if (interrupted.load()) {
+                break;
+            }
+        }
+        if (interrupted.load()) {
+            break;
+        }
+
+        statistics.bytesRead += source.size;
+        m_pool.start(new Task(this, source, sizes, cost));
+
+        if (progressTimer.hasExpired(ProgressInterval)) {
+            progressTimer.start();
+
+            statistics.generated = m_generated.load();
+            statistics.failed = m_failed.load();
+            statistics.elapsed = timer.elapsed();
+            printProgress(statistics);
+        }
+    }
+
+    m_pool.waitForDone();
+
+    statistics.generated = m_generated.load();
+    statistics.failed = m_failed.load();
+    statistics.elapsed = timer.elapsed();
+
+    return statistics;
+}
+
+QVector<NemoThumbnailWarmer::Source> NemoThumbnailWarmer::collectSources() const
+{
+    const QMimeDatabase mimeDatabase;
+
+    QVector<Source> sources;
+    for (const QString &directory : m_directories) {
+        QDirIterator iterator(directory, QDir::Files, QDirIterator::Subdirectories);
+        while (iterator.hasNext()) {
+            const QString path = iterator.next();
+            const QString mimeType = mimeDatabase.mimeTypeForFile(path, QMimeDatabase::MatchExtension).name();
+            if (mimeType.startsWith(QLatin1String("image/")) || mimeType.startsWith(QLatin1String("video/"))) {
+                const QFileInfo info = iterator.fileInfo();
+                sources.append({ path, mimeType, info.lastModified().toMSecsSinceEpoch(), info.size() });
+            }
+        }
+    }
+
+    std::sort(sources.begin(), sources.end(), [](const Source &left, const Source &right) {
+        return left.modified > right.modified;
+    });
+
+    return sources;
+}
+
+void NemoThumbnailWarmer::printProgress(const Statistics &statistics) const
+{
+    const qreal seconds = qMax<qint64>(1, statistics.elapsed) / 1000.0;
+
+    QTextStream(stdout) << statistics.sources << " sources, "
+                        << statistics.generated << " generated, "
+                        << statistics.skipped << " skipped, "
+                        << statistics.failed << " failed, "
+                        << QString::number(statistics.generated / seconds, 'f', 1) << " thumbnails/s, "
+                        << QString::number(statistics.bytesRead / seconds / (1 << 20), 'f', 1) << " MiB/s"
+                        << endl;
+}
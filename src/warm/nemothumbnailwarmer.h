@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#ifndef NEMOTHUMBNAILWARMER_H
+#define NEMOTHUMBNAILWARMER_H
+
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QSize>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+// Fills the cache with thumbnails for every image and video in a set of directories.
+//
+// Sources are generated in parallel on a pool of threads, newest first so the files a gallery
+// shows first are ready first.  The memory the decoded sources are estimated to use is limited
+// to a budget, and sources with an existing thumbnail of each size are skipped.
+class NemoThumbnailWarmer
+{
+public:
+    struct Statistics
+    {
+        int sources = 0;
+        int generated = 0;
+        int skipped = 0;
+        int failed = 0;
+        qint64 bytesRead = 0;
+        qint64 elapsed = 0;
+    };
+
+    NemoThumbnailWarmer(const QStringList &directories, const QVector<QSize> &sizes, bool crop);
+
+    void setThreadCount(int count);
+    void setMemoryBudget(int megabytes);
+
+    // Generates the thumbnails, returning early if interrupted is set.  Thumbnails already
+    // being generated are finished and written first.
+    Statistics run(const QAtomicInt &interrupted);
+
+private:
+    struct Source
+    {
+        QString path;
+        QString mimeType;
+        qint64 modified;
+        qint64 size;
+    };
+
+    class Task;
+
+    QVector<Source> collectSources() const;
+    void printProgress(const Statistics &statistics) const;
+
+    QStringList m_directories;
+    QVector<QSize> m_sizes;
+    QThreadPool m_pool;
+    QSemaphore m_budget;
+    int m_memoryBudget;
+    bool m_crop;
+
+    QAtomicInt m_generated;
+    QAtomicInt m_failed;
+};
+
+#endif // NEMOTHUMBNAILWARMER_H
@@ -0,0 +1,17 @@
+TEMPLATE = app
+TARGET = nemo-thumbnailer-warm
+
+CONFIG += c++17
+
+INCLUDEPATH += ../lib
+LIBS += -L../lib -lnemothumbnailer-qt$${QT_MAJOR_VERSION}
+
+SOURCES += \
+    main.cpp \
+    nemothumbnailwarmer.cpp
+HEADERS += \
+    nemothumbnailwarmer.h
+
+target.path = /usr/bin
+
+INSTALLS += target
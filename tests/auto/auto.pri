@@ -0,0 +1,11 @@
+TEMPLATE = app
+CONFIG += c++17
+QT += testlib
+
+TESTS_PATH = /opt/tests/nemo-qml-plugin-thumbnailer-qt5
+PLUGIN_PATH = $$PWD/../../src/plugin
+
+INCLUDEPATH += $$PLUGIN_PATH
+
+target.path = $$TESTS_PATH/auto
+INSTALLS += target
@@ -0,0 +1,7 @@
+include(../auto.pri)
+
+TARGET = tst_linkedlist
+QT -= gui
+
+SOURCES += tst_linkedlist.cpp
+HEADERS += $$PLUGIN_PATH/linkedlist.h
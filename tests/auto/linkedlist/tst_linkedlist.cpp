@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include <QtTest>
+
+#include "linkedlist.h"
+
+namespace {
+
+struct Node
+{
+    explicit Node(int value) : value(value) {}
+
+    int value;
+    LinkedListNode listNode;
+};
+
+typedef LinkedList<Node, &Node::listNode> NodeList;
+
+// No test puts more nodes than this in a list, a longer walk has gone around a mislinked node.
+const int MaximumLength = 16;
+
+// Returns the values of a list walking it forwards, and checks walking it backwards visits the
+// same nodes in reverse so a mislinked node fails either way.
+QList<int> values(NodeList &list)
+{
+    const QList<int> invalid = QList<int>() << -1;
+
+    QList<int> forwards;
+    for (NodeList::iterator it = list.begin(); it != list.end(); ++it) {
+        if (forwards.count() == MaximumLength)
+            return invalid;
+        forwards.append(it->value);
+    }
+
+    QList<int> backwards;
+    NodeList::iterator it = list.end();
+    while (it != list.begin()) {
+        if (backwards.count() == MaximumLength)
+            return invalid;
+        --it;
+        backwards.prepend(it->value);
+    }
+
+    return forwards == backwards ? forwards : invalid;
+}
+
+}
+
+class tst_LinkedList : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void append();
+    void prepend();
+    void insertAfter();
+    void insertBefore();
+    void moveBetweenLists();
+    void take();
+    void erase();
+};
+
+void tst_LinkedList::append()
+{
+    Node a(1), b(2), c(3);
+    NodeList list;
+
+    list.append(&a);
+    list.append(&b);
+    list.append(&c);
+
+    QCOMPARE(values(list), QList<int>() << 1 << 2 << 3);
+    QCOMPARE(list.first(), &a);
+    QCOMPARE(list.last(), &c);
+}
+
+void tst_LinkedList::prepend()
+{
+    Node a(1), b(2), c(3);
+    NodeList list;
+
+    list.prepend(&a);
+    QCOMPARE(values(list), QList<int>() << 1);
+
+    list.prepend(&b);
+    list.prepend(&c);
+    QCOMPARE(values(list), QList<int>() << 3 << 2 << 1);
+
+    // Prepending a node already in the list moves it to the front.
+    list.prepend(&a);
+    QCOMPARE(values(list), QList<int>() << 1 << 3 << 2);
+    QCOMPARE(list.first(), &a);
+    QCOMPARE(list.last(), &b);
+}
+
+void tst_LinkedList::insertAfter()
+{
+    Node a(1), b(2), c(3), d(4);
+    NodeList list;
+
+    list.append(&a);
+    list.append(&b);
+
+    list.insertAfter(&a, &c);
+    QCOMPARE(values(list), QList<int>() << 1 << 3 << 2);
+
+    list.insertAfter(&b, &d);
+    QCOMPARE(values(list), QList<int>() << 1 << 3 << 2 << 4);
+    QCOMPARE(list.last(), &d);
+
+    list.insertAfter(&d, &a);
+    QCOMPARE(values(list), QList<int>() << 3 << 2 << 4 << 1);
+}
+
+void tst_LinkedList::insertBefore()
+{
+    Node a(1), b(2), c(3);
+    NodeList list;
+
+    list.append(&a);
+    list.insertBefore(&a, &b);
+    list.insertBefore(&a, &c);
+
+    QCOMPARE(values(list), QList<int>() << 2 << 3 << 1);
+}
+
+void tst_LinkedList::moveBetweenLists()
+{
+    Node a(1), b(2), c(3);
+    NodeList first;
+    NodeList second;
+
+    first.append(&a);
+    first.append(&b);
+    first.append(&c);
+
+    // A node is only ever in one list, adding it to another removes it from the first.
+    second.prepend(&b);
+    second.prepend(&a);
+
+    QCOMPARE(values(first), QList<int>() << 3);
+    QCOMPARE(values(second), QList<int>() << 1 << 2);
+}
+
+void tst_LinkedList::take()
+{
+    Node a(1), b(2), c(3);
+    NodeList list;
+
+    list.append(&a);
+    list.append(&b);
+    list.append(&c);
+
+    QCOMPARE(list.takeFirst(), &a);
+    QCOMPARE(list.takeLast(), &c);
+    QCOMPARE(list.takeFirst(), &b);
+    QVERIFY(list.isEmpty());
+    QCOMPARE(list.takeFirst(), static_cast<Node *>(nullptr));
+}
+
+void tst_LinkedList::erase()
+{
+    NodeList list;
+    Node a(1);
+    list.append(&a);
+
+    {
+        Node b(2);
+        list.append(&b);
+        list.prepend(&b);
+        QCOMPARE(values(list), QList<int>() << 2 << 1);
+    }
+
+    // A destroyed node unlinks itself.
+    QCOMPARE(values(list), QList<int>() << 1);
+
+    a.listNode.erase();
+    QVERIFY(list.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(tst_LinkedList)
+
+#include "tst_linkedlist.moc"
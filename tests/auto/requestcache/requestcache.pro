@@ -0,0 +1,18 @@
+include(../auto.pri)
+
+TARGET = tst_requestcache
+QT += qml quick
+
+INCLUDEPATH += $$PWD/../../../src/lib
+LIBS += -L$$OUT_PWD/../../../src/lib -lnemothumbnailer-qt$${QT_MAJOR_VERSION} -lrt
+
+SOURCES += \
+    tst_requestcache.cpp \
+    $$PLUGIN_PATH/nemothumbnailitem.cpp \
+    $$PLUGIN_PATH/nemothumbnailrecorder.cpp \
+    $$PLUGIN_PATH/nemothumbnailrequestcache.cpp
+HEADERS += \
+    $$PLUGIN_PATH/linkedlist.h \
+    $$PLUGIN_PATH/nemothumbnailitem.h \
+    $$PLUGIN_PATH/nemothumbnailrecorder.h \
+    $$PLUGIN_PATH/nemothumbnailrequestcache.h
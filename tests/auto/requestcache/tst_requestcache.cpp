@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include <QtTest>
+#include <QGuiApplication>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQuickView>
+
+#include "nemothumbnailitem.h"
+
+namespace {
+
+const char * const thumbnailQml =
+        "import QtQuick 2.0\n"
+        "import Nemo.Thumbnailer 1.0\n"
+        "Thumbnail {\n"
+        "    width: 32; height: 32\n"
+        "    sourceSize.width: 32; sourceSize.height: 32\n"
+        "}\n";
+
+const char * const sourceNames[] = { "a.png", "b.png", "c.png", "d.png" };
+
+}
+
+// Checks requests are identified by every property of their key and that the loader releases
+// the least recently used requests which no item shows once it is over its maximum cost.
+class tst_RequestCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void key_data();
+    void key();
+    void transposedSizes();
+
+    void evictionOrder();
+    void failedRequestKeptWhileShown();
+
+private:
+    NemoThumbnailItem *createItem();
+    bool show(NemoThumbnailItem *item, const QString &path);
+    NemoThumbnailLoader::Statistics statistics();
+
+    QTemporaryDir m_cacheDirectory;
+    QTemporaryDir m_sourceDirectory;
+    QScopedPointer<QQuickView> m_view;
+};
+
+void tst_RequestCache::initTestCase()
+{
+    QVERIFY(m_cacheDirectory.isValid());
+    QVERIFY(m_sourceDirectory.isValid());
+
+    // Must be set before the cache is first used.
+    qputenv("XDG_CACHE_HOME", QFile::encodeName(m_cacheDirectory.path()));
+    qputenv("NEMO_THUMBNAILER_DAEMON", "0");
+
+    qmlRegisterType<NemoThumbnailItem>("Nemo.Thumbnailer", 1, 0, "Thumbnail");
+
+    const QColor colors[] = { Qt::red, Qt::green, Qt::blue, Qt::yellow };
+    for (int i = 0; i < 4; ++i) {
+        QImage image(64, 64, QImage::Format_RGB32);
+        image.fill(colors[i]);
+        QVERIFY(image.save(m_sourceDirectory.filePath(QLatin1String(sourceNames[i]))));
+    }
+
+    m_view.reset(new QQuickView);
+    m_view->resize(64, 64);
+    m_view->show();
+}
+
+void tst_RequestCache::key_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("stripFrames");
+    QTest::addColumn<bool>("crop");
+    QTest::addColumn<bool>("equal");
+
+    QTest::newRow("same") << QStringLiteral("/a.jpg") << QSize(100, 200) << 0 << true << true;
+    QTest::newRow("file name") << QStringLiteral("/b.jpg") << QSize(100, 200) << 0 << true << false;
+    QTest::newRow("width") << QStringLiteral("/a.jpg") << QSize(101, 200) << 0 << true << false;
+    QTest::newRow("height") << QStringLiteral("/a.jpg") << QSize(100, 201) << 0 << true << false;
+    QTest::newRow("strip frames") << QStringLiteral("/a.jpg") << QSize(100, 200) << 8 << true << false;
+    QTest::newRow("crop") << QStringLiteral("/a.jpg") << QSize(100, 200) << 0 << false << false;
+}
+
+void tst_RequestCache::key()
+{
+    QFETCH(QString, fileName);
+    QFETCH(QSize, size);
+    QFETCH(int, stripFrames);
+    QFETCH(bool, crop);
+    QFETCH(bool, equal);
+
+    const ThumbnailRequestKey reference = { QStringLiteral("/a.jpg"), QSize(100, 200), 0, true };
+    const ThumbnailRequestKey key = { fileName, size, stripFrames, crop };
+
+    QCOMPARE(key == reference, equal);
+    QCOMPARE(reference == key, equal);
+    if (equal)
+        QCOMPARE(qHash(key), qHash(reference));
+}
+
+void tst_RequestCache::transposedSizes()
+{
+    const ThumbnailRequestKey portrait = { QStringLiteral("/a.jpg"), QSize(100, 200), 0, true };
+    const ThumbnailRequestKey landscape = { QStringLiteral("/a.jpg"), QSize(200, 100), 0, true };
+
+    QVERIFY(!(portrait == landscape));
+    QVERIFY(qHash(portrait) != qHash(landscape));
+
+    NemoThumbnailItem item;
+    ThumbnailRequest *portraitRequest = new ThumbnailRequest(&item, portrait);
+    ThumbnailRequest *landscapeRequest = new ThumbnailRequest(&item, landscape);
+
+    ThumbnailRequestCache cache;
+    cache.insert(portraitRequest);
+    cache.insert(landscapeRequest);
+
+    QCOMPARE(cache.value(portrait), portraitRequest);
+    QCOMPARE(cache.value(landscape), landscapeRequest);
+    QCOMPARE(cache.requests().count(), 2);
+
+    cache.remove(portraitRequest);
+    QCOMPARE(cache.value(portrait), static_cast<ThumbnailRequest *>(nullptr));
+    QCOMPARE(cache.value(landscape), landscapeRequest);
+    QCOMPARE(cache.requests().count(), 1);
+
+    cache.remove(landscapeRequest);
+    QVERIFY(cache.requests().isEmpty());
+
+    delete portraitRequest;
+    delete landscapeRequest;
+}
+
+void tst_RequestCache::evictionOrder()
+{
+    QScopedPointer<NemoThumbnailItem> item(createItem());
+    QVERIFY(item);
+
+    NemoThumbnailLoader *loader = qobject_cast<NemoThumbnailLoader *>(
+                qmlAttachedPropertiesObject<NemoThumbnailItem>(m_view.data()));
+    QVERIFY(loader);
+    const int maxCost = loader->maxCost();
+
+    // Measure the cost of one thumbnail and allow two to be cached besides the one shown.
+    QVERIFY(show(item.data(), QLatin1String(sourceNames[0])));
+    const int cost = statistics().totalCost;
+    QVERIFY(cost > 0);
+    loader->setMaxCost(3 * cost);
+
+    QVERIFY(show(item.data(), QLatin1String(sourceNames[1])));
+    QVERIFY(show(item.data(), QLatin1String(sourceNames[2])));
+    // The fourth thumbnail puts the loader over its maximum cost, so the next change of source
+    // releases the least recently used request, which is a.
+    QVERIFY(show(item.data(), QLatin1String(sourceNames[3])));
+
+    // b and c are still cached and a has to be loaded again.
+    const NemoThumbnailLoader::Statistics before = statistics();
+    QVERIFY(show(item.data(), QLatin1String(sourceNames[2])));
+    QVERIFY(show(item.data(), QLatin1String(sourceNames[1])));
+    QCOMPARE(statistics().memoryHits - before.memoryHits, 2);
+    QCOMPARE(statistics().memoryMisses - before.memoryMisses, 0);
+
+    QVERIFY(show(item.data(), QLatin1String(sourceNames[0])));
+    QCOMPARE(statistics().memoryMisses - before.memoryMisses, 1);
+
+    loader->setMaxCost(maxCost);
+}
+
+void tst_RequestCache::failedRequestKeptWhileShown()
+{
+    QScopedPointer<NemoThumbnailItem> first(createItem());
+    QScopedPointer<NemoThumbnailItem> second(createItem());
+    QVERIFY(first);
+    QVERIFY(second);
+
+    NemoThumbnailLoader *loader = qobject_cast<NemoThumbnailLoader *>(
+                qmlAttachedPropertiesObject<NemoThumbnailItem>(m_view.data()));
+    QVERIFY(loader);
+    const int maxCost = loader->maxCost();
+
+    // Release every request no item shows.
+    loader->setMaxCost(0);
+
+    QVERIFY(show(first.data(), QStringLiteral("missing.png")));
+    QCOMPARE(first->status(), NemoThumbnailItem::Error);
+
+    // The failed request becomes unreferenced and then shown by the second item.
+    QVERIFY(show(first.data(), QLatin1String(sourceNames[0])));
+    QVERIFY(show(second.data(), QStringLiteral("missing.png")));
+    QCOMPARE(second->status(), NemoThumbnailItem::Error);
+
+    // Releasing requests to get under the maximum cost mustn't release the one still shown.
+    const NemoThumbnailLoader::Statistics before = statistics();
+    QVERIFY(show(first.data(), QLatin1String(sourceNames[1])));
+    QCOMPARE(second->status(), NemoThumbnailItem::Error);
+
+    QScopedPointer<NemoThumbnailItem> third(createItem());
+    QVERIFY(third);
+    QVERIFY(show(third.data(), QStringLiteral("missing.png")));
+    QCOMPARE(statistics().memoryHits - before.memoryHits, 1);
+
+    loader->setMaxCost(maxCost);
+}
+
+NemoThumbnailItem *tst_RequestCache::createItem()
+{
+    QQmlComponent component(m_view->engine());
+    component.setData(thumbnailQml, QUrl());
+    NemoThumbnailItem *item = qobject_cast<NemoThumbnailItem *>(component.create());
+    if (!item) {
+        qWarning() << component.errors();
+        return nullptr;
+    }
+    item->setParentItem(m_view->contentItem());
+
+    // The loader is attached to the window once the item is in the scene.
+    QCoreApplication::processEvents();
+    return item;
+}
+
+// Shows a source and waits for it to load or fail.
+bool tst_RequestCache::show(NemoThumbnailItem *item, const QString &path)
+{
+    item->setSource(QUrl::fromLocalFile(m_sourceDirectory.filePath(path)));
+
+    QElapsedTimer timeout;
+    timeout.start();
+    while (item->status() == NemoThumbnailItem::Loading) {
+        if (timeout.hasExpired(10000))
+            return false;
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+    return item->status() == NemoThumbnailItem::Ready || item->status() == NemoThumbnailItem::Error;
+}
+
+NemoThumbnailLoader::Statistics tst_RequestCache::statistics()
+{
+    NemoThumbnailLoader *loader = qobject_cast<NemoThumbnailLoader *>(
+                qmlAttachedPropertiesObject<NemoThumbnailItem>(m_view.data()));
+    return loader ? loader->statistics() : NemoThumbnailLoader::Statistics();
+}
+
+int main(int argc, char *argv[])
+{
+    // Run without a display or GPU.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    qputenv("QT_QUICK_BACKEND", "software");
+
+    QGuiApplication app(argc, argv);
+
+    tst_RequestCache test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_requestcache.moc"
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include <QtTest>
+
+#include "nemothumbnailprotocol_p.h"
+#include "nemothumbnailwatcher.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Checks a watched directory is only published to the cache while every directory below it
+// could be watched.
+class tst_Watcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void unwatchableDirectory_data();
+    void unwatchableDirectory();
+
+private:
+    QScopedPointer<QTemporaryDir> m_cacheDirectory;
+    QScopedPointer<QTemporaryDir> m_sourceDirectory;
+    QString m_lockedPath;
+};
+
+void tst_Watcher::init()
+{
+    m_cacheDirectory.reset(new QTemporaryDir);
+    m_sourceDirectory.reset(new QTemporaryDir);
+}
+
+void tst_Watcher::cleanup()
+{
+    // The temporary directory can't be removed while a directory in it is unreadable.
+    if (!m_lockedPath.isEmpty()) {
+        ::chmod(QFile::encodeName(m_lockedPath).constData(), 0755);
+        m_lockedPath.clear();
+    }
+
+    m_sourceDirectory.reset();
+    m_cacheDirectory.reset();
+}
+
+void tst_Watcher::unwatchableDirectory_data()
+{
+    QTest::addColumn<bool>("missing");
+
+    QTest::newRow("missing directory") << true;
+    QTest::newRow("unreadable subdirectory") << false;
+}
+
+void tst_Watcher::unwatchableDirectory()
+{
+    QFETCH(bool, missing);
+
+    if (!missing && ::geteuid() == 0) {
+        QSKIP("Directory permissions don't apply to root");
+    }
+
+    QVERIFY(m_cacheDirectory->isValid());
+    QVERIFY(m_sourceDirectory->isValid());
+
+    const QString cachePath = m_cacheDirectory->path();
+    const QString watched = m_sourceDirectory->path() + QLatin1String("/watched");
+    const QString unwatched = m_sourceDirectory->path() + QLatin1String("/unwatched");
+    QVERIFY(QDir().mkpath(watched + QLatin1String("/subdirectory")));
+
+    if (!missing) {
+        m_lockedPath = unwatched + QLatin1String("/locked");
+        QVERIFY(QDir().mkpath(m_lockedPath));
+        QCOMPARE(::chmod(QFile::encodeName(m_lockedPath).constData(), 0), 0);
+    }
+
+    NemoThumbnailWatcher watcher(cachePath, QStringList() << watched << unwatched);
+    QVERIFY(watcher.start());
+
+    QFile state(NemoThumbnailProtocol::watchStatePath(cachePath));
+    QTRY_VERIFY(state.exists());
+    QVERIFY(state.open(QIODevice::ReadOnly));
+
+    QStringList directories = QString::fromUtf8(state.readAll()).split(
+                QLatin1Char('\n'), QString::SkipEmptyParts);
+    QVERIFY(directories.count() >= 2);
+    directories = directories.mid(2);
+
+    QCOMPARE(directories, QStringList() << watched);
+}
+
+QTEST_GUILESS_MAIN(tst_Watcher)
+
+#include "tst_watcher.moc"
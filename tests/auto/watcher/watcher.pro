@@ -0,0 +1,13 @@
+include(../auto.pri)
+
+TARGET = tst_watcher
+
+DAEMON_PATH = $$PWD/../../../src/daemon
+
+INCLUDEPATH += $$PWD/../../../src/lib $$DAEMON_PATH
+
+SOURCES += \
+    tst_watcher.cpp \
+    $$DAEMON_PATH/nemothumbnailwatcher.cpp
+HEADERS += \
+    $$DAEMON_PATH/nemothumbnailwatcher.h
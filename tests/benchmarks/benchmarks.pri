@@ -0,0 +1,18 @@
+TEMPLATE = app
+CONFIG += c++17
+QT += testlib
+
+TESTS_PATH = /opt/tests/nemo-qml-plugin-thumbnailer-qt5
+CORPUS_BUILD_PATH = $$shadowed($$PWD)/corpus/corpus
+
+DEFINES += \
+    NEMO_THUMBNAILER_CORPUS_PATH=\\\"$$TESTS_PATH/corpus\\\" \
+    NEMO_THUMBNAILER_CORPUS_BUILD_PATH=\\\"$$CORPUS_BUILD_PATH\\\"
+
+INCLUDEPATH += \
+    $$PWD/common \
+    $$PWD/../../src/lib
+HEADERS += $$PWD/common/corpus.h
+
+target.path = $$TESTS_PATH/benchmarks
+INSTALLS += target
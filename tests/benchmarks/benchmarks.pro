@@ -0,0 +1,9 @@
+TEMPLATE = subdirs
+SUBDIRS = corpus scaler codec cache pagecache loader replay
+
+scaler.depends = corpus
+codec.depends = corpus
+cache.depends = corpus
+pagecache.depends = corpus
+loader.depends = corpus
+replay.depends = corpus
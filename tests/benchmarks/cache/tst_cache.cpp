@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include <QtTest>
+#include <QImageReader>
+
+#include <nemothumbnailcache.h>
+
+#include "corpus.h"
+#include "nemothumbnailprotocol_p.h"
+
+namespace {
+
+class BenchmarkCache : public NemoThumbnailCache
+{
+public:
+    explicit BenchmarkCache(const QString &cachePath)
+        : NemoThumbnailCache(cachePath)
+    {
+    }
+
+    using NemoThumbnailCache::generateThumbnail;
+    using NemoThumbnailCache::readImageThumbnail;
+    using NemoThumbnailCache::waitForCacheFile;
+    using NemoThumbnailCache::writeCacheFile;
+};
+
+}
+
+// Measures the stages of looking up, generating and storing a thumbnail.
+class tst_Cache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void cacheKey();
+    void existingThumbnail_data();
+    void existingThumbnail();
+    void cachedImage_data();
+    void cachedImage();
+    void generateThumbnail_data();
+    void generateThumbnail();
+    void readImageThumbnail_data();
+    void readImageThumbnail();
+    void writeCacheFile_data();
+    void writeCacheFile();
+
+private:
+    void addFileRows();
+    void warm(const QString &path, const QSize &size);
+
+    QScopedPointer<QTemporaryDir> m_cacheDirectory;
+    QScopedPointer<BenchmarkCache> m_cache;
+};
+
+void tst_Cache::initTestCase()
+{
+    qputenv("NEMO_THUMBNAILER_DAEMON", "0");
+    QVERIFY2(!corpusFiles().isEmpty(), "The benchmark corpus is missing");
+}
+
+void tst_Cache::init()
+{
+    // Every test starts with a cold cache.
+    m_cacheDirectory.reset(new QTemporaryDir);
+    QVERIFY(m_cacheDirectory->isValid());
+    m_cache.reset(new BenchmarkCache(m_cacheDirectory->path()));
+}
+
+void tst_Cache::cleanup()
+{
+    m_cache.reset();
+    m_cacheDirectory.reset();
+}
+
+void tst_Cache::addFileRows()
+{
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<QSize>("size");
+
+    for (const QString &path : corpusFiles()) {
+        const QString name = QFileInfo(path).fileName();
+        QTest::addRow("%s 128", qPrintable(name)) << path << QSize(128, 128);
+        QTest::addRow("%s 512", qPrintable(name)) << path << QSize(512, 512);
+    }
+}
+
+void tst_Cache::warm(const QString &path, const QSize &size)
+{
+    const NemoThumbnailCache::ThumbnailData thumbnail = m_cache->requestThumbnail(path, size, true);
+    QVERIFY(thumbnail.validPath());
+    QVERIFY(BenchmarkCache::waitForCacheFile(thumbnail.path()));
+}
+
+void tst_Cache::cacheKey()
+{
+    const QString path = corpusFiles().first();
+
+    QByteArray key;
+    QBENCHMARK {
+        key = NemoThumbnailProtocol::sourceHash(path) + "-256";
+    }
+
+    QCOMPARE(key.size(), 44);
+}
+
+void tst_Cache::existingThumbnail_data()
+{
+    QTest::addColumn<bool>("warm");
+
+    QTest::newRow("cold") << false;
+    QTest::newRow("warm") << true;
+}
+
+void tst_Cache::existingThumbnail()
+{
+    QFETCH(bool, warm);
+
+    const QString path = corpusFiles().first();
+    const QSize size(256, 256);
+    if (warm) {
+        this->warm(path, size);
+    }
+
+    NemoThumbnailCache::ThumbnailData thumbnail;
+    QBENCHMARK {
+        thumbnail = m_cache->existingThumbnail(path, size, true);
+    }
+
+    QCOMPARE(thumbnail.validPath(), warm);
+}
+
+void tst_Cache::cachedImage_data()
+{
+    addFileRows();
+}
+
+void tst_Cache::cachedImage()
+{
+    QFETCH(QString, path);
+    QFETCH(QSize, size);
+
+    warm(path, size);
+
+    // A cache hit from lookup to the image displayed.
+    QImage image;
+    QBENCHMARK {
+        image = m_cache->existingThumbnail(path, size, true).getScaledImage(size, true);
+    }
+
+    QVERIFY(!image.isNull());
+}
+
+void tst_Cache::generateThumbnail_data()
+{
+    addFileRows();
+}
+
+void tst_Cache::generateThumbnail()
+{
+    QFETCH(QString, path);
+    QFETCH(QSize, size);
+
+    const QByteArray key = NemoThumbnailProtocol::sourceHash(path) + "-benchmark";
+
+    NemoThumbnailCache::ThumbnailData thumbnail;
+    QBENCHMARK {
+        thumbnail = m_cache->generateThumbnail(path, key, size.width(), true, QString());
+    }
+
+    QVERIFY(thumbnail.validImage());
+}
+
+void tst_Cache::readImageThumbnail_data()
+{
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<bool>("smooth");
+
+    for (const QString &path : corpusFiles()) {
+        const QString name = QFileInfo(path).fileName();
+        QTest::addRow("%s 256 fast", qPrintable(name)) << path << QSize(256, 256) << false;
+        QTest::addRow("%s 256 smooth", qPrintable(name)) << path << QSize(256, 256) << true;
+    }
+}
+
+void tst_Cache::readImageThumbnail()
+{
+    QFETCH(QString, path);
+    QFETCH(QSize, size);
+    QFETCH(bool, smooth);
+
+    QImage image;
+    QBENCHMARK {
+        QImageReader reader(path);
+        image = BenchmarkCache::readImageThumbnail(
+                    &reader, size, true, smooth ? Qt::SmoothTransformation : Qt::FastTransformation);
+    }
+
+    QVERIFY(!image.isNull());
+}
+
+void tst_Cache::writeCacheFile_data()
+{
+    QTest::addColumn<QString>("path");
+
+    QTest::newRow("opaque") << corpusPath() + QLatin1String("/photo-1920x1080.jpg");
+    QTest::newRow("alpha") << corpusPath() + QLatin1String("/alpha-1024x1024.png");
+}
+
+void tst_Cache::writeCacheFile()
+{
+    QFETCH(QString, path);
+
+    QImage image = QImage(path).scaled(512, 512, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    image = image.convertToFormat(image.hasAlphaChannel()
+            ? QImage::Format_RGBA8888_Premultiplied
+            : QImage::Format_RGBX8888);
+
+    const QByteArray key = NemoThumbnailProtocol::sourceHash(path) + "-benchmark";
+
+    QString thumbnailPath;
+    QBENCHMARK {
+        thumbnailPath = m_cache->writeCacheFile(key, image);
+    }
+
+    QVERIFY(!thumbnailPath.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(tst_Cache)
+
+#include "tst_cache.moc"
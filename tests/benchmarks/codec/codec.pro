@@ -0,0 +1,11 @@
+include(../benchmarks.pri)
+
+TARGET = tst_codec
+QT += gui
+
+LIB_PATH = ../../../src/lib
+
+SOURCES += \
+    tst_codec.cpp \
+    $$LIB_PATH/nemoqoicodec.cpp
+HEADERS += $$LIB_PATH/nemoqoicodec_p.h
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include <QtTest>
+#include <QBuffer>
+#include <QPainter>
+
+#include "corpus.h"
+#include "nemoqoicodec_p.h"
+
+// Compares the QOI cache entry format against the PNG and JPEG formats previously used.
+class tst_Codec : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void encode_data();
+    void encode();
+    void decode_data();
+    void decode();
+
+private:
+    void addRows();
+    QByteArray encoded(const QImage &image, const QByteArray &format) const;
+
+    QHash<QByteArray, QImage> m_images;
+};
+
+void tst_Codec::initTestCase()
+{
+    const QImage photo(corpusPath() + QLatin1String("/photo-1920x1080.jpg"));
+    const QImage alpha(corpusPath() + QLatin1String("/alpha-1024x1024.png"));
+    QVERIFY2(!photo.isNull() && !alpha.isNull(), "The benchmark corpus is missing");
+
+    // Thumbnail sized images in the formats they are stored in.
+    m_images.insert("photo", photo.scaled(512, 288, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                    .convertToFormat(QImage::Format_RGBX8888));
+    m_images.insert("alpha", alpha.scaled(512, 512, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                    .convertToFormat(QImage::Format_RGBA8888_Premultiplied));
+
+    // Large flat areas like a screenshot.
+    QImage screenshot(720, 1280, QImage::Format_RGBX8888);
+    screenshot.fill(Qt::white);
+    QPainter painter(&screenshot);
+    for (int y = 0; y < screenshot.height(); y += 96) {
+        painter.fillRect(24, y + 12, 672, 72, QColor(0x30, 0x60, 0xa0));
+        painter.fillRect(36, y + 24, 48, 48, QColor(0xe0, 0x80, 0x20));
+    }
+    painter.end();
+    m_images.insert("screenshot", screenshot);
+}
+
+void tst_Codec::addRows()
+{
+    QTest::addColumn<QByteArray>("image");
+    QTest::addColumn<QByteArray>("format");
+
+    const char * const images[] = { "photo", "alpha", "screenshot" };
+    for (const char *image : images) {
+        QTest::addRow("%s qoi", image) << QByteArray(image) << QByteArray("qoi");
+        QTest::addRow("%s png", image) << QByteArray(image) << QByteArray("png");
+        if (!m_images.value(image).hasAlphaChannel()) {
+            QTest::addRow("%s jpg", image) << QByteArray(image) << QByteArray("jpg");
+        }
+    }
+}
+
+QByteArray tst_Codec::encoded(const QImage &image, const QByteArray &format) const
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    if (format == "qoi") {
+        NemoQoiCodec::write(&buffer, image);
+    } else {
+        image.save(&buffer, format.constData());
+    }
+    return buffer.data();
+}
+
+void tst_Codec::encode_data()
+{
+    addRows();
+}
+
+void tst_Codec::encode()
+{
+    QFETCH(QByteArray, image);
+    QFETCH(QByteArray, format);
+
+    const QImage source = m_images.value(image);
+
+    QByteArray data;
+    QBENCHMARK {
+        data = encoded(source, format);
+    }
+
+    QVERIFY(!data.isEmpty());
+    qInfo("%s: %d bytes", QTest::currentDataTag(), data.size());
+}
+
+void tst_Codec::decode_data()
+{
+    addRows();
+}
+
+void tst_Codec::decode()
+{
+    QFETCH(QByteArray, image);
+    QFETCH(QByteArray, format);
+
+    const QByteArray data = encoded(m_images.value(image), format);
+
+    QImage result;
+    QBENCHMARK {
+        if (format == "qoi") {
+            result = NemoQoiCodec::decode(reinterpret_cast<const uchar *>(data.constData()), data.size());
+        } else {
+            result = QImage::fromData(data, format.constData());
+        }
+    }
+
+    QCOMPARE(result.size(), m_images.value(image).size());
+}
+
+QTEST_GUILESS_MAIN(tst_Codec)
+
+#include "tst_codec.moc"
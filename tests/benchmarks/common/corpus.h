@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef NEMOTHUMBNAILER_BENCHMARKS_CORPUS_H
+#define NEMOTHUMBNAILER_BENCHMARKS_CORPUS_H
+
+#include <QDir>
+#include <QFileInfo>
+#include <QStringList>
+
+// The synthetic images generated at build time by the corpus tool.  The installed corpus is
+// preferred so the benchmarks can run on a device, NEMO_THUMBNAILER_CORPUS overrides both.
+inline QString corpusPath()
+{
+    const QByteArray override = qgetenv("NEMO_THUMBNAILER_CORPUS");
+    if (!override.isEmpty()) {
+        return QFile::decodeName(override);
+    } else if (QFileInfo(QStringLiteral(NEMO_THUMBNAILER_CORPUS_PATH)).isDir()) {
+        return QStringLiteral(NEMO_THUMBNAILER_CORPUS_PATH);
+    } else {
+        return QStringLiteral(NEMO_THUMBNAILER_CORPUS_BUILD_PATH);
+    }
+}
+
+inline QStringList corpusFiles()
+{
+    const QDir corpus(corpusPath());
+
+    QStringList files;
+    for (const QString &name : corpus.entryList(QDir::Files, QDir::Name)) {
+        files.append(corpus.filePath(name));
+    }
+    return files;
+}
+
+#endif // NEMOTHUMBNAILER_BENCHMARKS_CORPUS_H
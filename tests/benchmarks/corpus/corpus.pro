@@ -0,0 +1,16 @@
+TEMPLATE = app
+TARGET = generate-corpus
+CONFIG += c++17
+QT += gui
+
+SOURCES += main.cpp
+
+TESTS_PATH = /opt/tests/nemo-qml-plugin-thumbnailer-qt5
+
+# Generate the images as part of the build so they don't need to be stored in the repository.
+QMAKE_POST_LINK = ./$$TARGET $$OUT_PWD/corpus
+
+corpus.files = $$OUT_PWD/corpus
+corpus.path = $$TESTS_PATH
+corpus.CONFIG += no_check_exist
+INSTALLS += corpus
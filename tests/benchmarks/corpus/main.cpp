@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QImage>
+#include <QImageWriter>
+
+#include <cmath>
+
+namespace {
+
+struct CorpusImage
+{
+    const char *name;
+    QSize size;
+    bool alpha;
+    QImageIOHandler::Transformations transformation;
+};
+
+const CorpusImage corpusImages[] = {
+    { "photo-640x480.jpg", QSize(640, 480), false, QImageIOHandler::TransformationNone },
+    { "photo-1920x1080.jpg", QSize(1920, 1080), false, QImageIOHandler::TransformationNone },
+    { "photo-4032x3024.jpg", QSize(4032, 3024), false, QImageIOHandler::TransformationNone },
+    { "photo-4032x3024-rotated.jpg", QSize(4032, 3024), false, QImageIOHandler::TransformationRotate90 },
+    { "photo-1920x1080.png", QSize(1920, 1080), false, QImageIOHandler::TransformationNone },
+    { "alpha-256x256.png", QSize(256, 256), true, QImageIOHandler::TransformationNone },
+    { "alpha-1024x1024.png", QSize(1024, 1024), true, QImageIOHandler::TransformationNone },
+};
+
+// Gradients with some noise so compressed sizes and decode times resemble a photo rather than
+// a flat graphic.  The noise is deterministic so the corpus is the same for every build.
+QImage syntheticImage(const QSize &size, bool alpha)
+{
+    QImage image(size, alpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+
+    quint32 seed = size.width() * 31 + size.height();
+    const qreal radius = qMin(size.width(), size.height()) / 2.0;
+
+    for (int y = 0; y < size.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            seed = seed * 1664525u + 1013904223u;
+            const int noise = int(seed >> 27) - 16;
+
+            const int red = qBound(0, x * 255 / size.width() + noise, 255);
+            const int green = qBound(0, y * 255 / size.height() + noise, 255);
+            const int blue = qBound(0, ((x / 64 + y / 64) % 2) * 160 + noise + 48, 255);
+
+            int opacity = 255;
+            if (alpha) {
+                const qreal distance = std::hypot(x - size.width() / 2.0, y - size.height() / 2.0);
+                opacity = qBound(0, int(255 * (1.5 - distance / radius)), 255);
+            }
+
+            line[x] = qRgba(red, green, blue, opacity);
+        }
+    }
+
+    return image;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc != 2) {
+        qWarning("Usage: generate-corpus <directory>");
+        return EXIT_FAILURE;
+    }
+
+    const QDir directory(QString::fromLocal8Bit(argv[1]));
+    if (!directory.mkpath(QStringLiteral("."))) {
+        qWarning() << "Cannot create" << directory.path();
+        return EXIT_FAILURE;
+    }
+
+    for (const CorpusImage &corpusImage : corpusImages) {
+        const QString path = directory.filePath(QLatin1String(corpusImage.name));
+        if (QFileInfo::exists(path)) {
+            continue;
+        }
+
+        QImageWriter writer(path);
+        writer.setQuality(90);
+        writer.setTransformation(corpusImage.transformation);
+        if (!writer.write(syntheticImage(corpusImage.size, corpusImage.alpha))) {
+            qWarning() << "Cannot write" << path << writer.errorString();
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
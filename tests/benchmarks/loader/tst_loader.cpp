@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include <QtTest>
+#include <QGuiApplication>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQuickView>
+
+#include "corpus.h"
+#include "nemothumbnailitem.h"
+
+namespace {
+
+const int ItemCount = 120;
+
+const char * const gridQml =
+        "import QtQuick 2.0\n"
+        "import Nemo.Thumbnailer 1.0\n"
+        "Grid {\n"
+        "    property var sources\n"
+        "    columns: 10\n"
+        "    Repeater {\n"
+        "        model: sources\n"
+        "        Thumbnail {\n"
+        "            width: 96; height: 96\n"
+        "            sourceSize.width: 256; sourceSize.height: 256\n"
+        "            source: modelData\n"
+        "        }\n"
+        "    }\n"
+        "}\n";
+
+}
+
+// Measures how long the Thumbnail item takes to display a grid of thumbnails, from a cold
+// cache which generates every thumbnail and a warm cache which only loads them.
+class tst_Loader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void grid_data();
+    void grid();
+
+private:
+    int loadGrid(const QStringList &sources);
+
+    QTemporaryDir m_cacheDirectory;
+    QTemporaryDir m_sourceDirectory;
+    QStringList m_sources;
+};
+
+void tst_Loader::initTestCase()
+{
+    QVERIFY(m_cacheDirectory.isValid());
+    QVERIFY(m_sourceDirectory.isValid());
+
+    // Must be set before the cache is first used.
+    qputenv("XDG_CACHE_HOME", QFile::encodeName(m_cacheDirectory.path()));
+    qputenv("NEMO_THUMBNAILER_DAEMON", "0");
+
+    qmlRegisterType<NemoThumbnailItem>("Nemo.Thumbnailer", 1, 0, "Thumbnail");
+
+    const QStringList corpus = corpusFiles();
+    QVERIFY2(!corpus.isEmpty(), "The benchmark corpus is missing");
+
+    // Links to the corpus give every item its own source and so its own cache entry.
+    for (int i = 0; i < ItemCount; ++i) {
+        const QString source = corpus.at(i % corpus.count());
+        const QString link = m_sourceDirectory.filePath(
+                    QStringLiteral("%1-%2").arg(i).arg(QFileInfo(source).fileName()));
+        QVERIFY(QFile::link(source, link));
+        m_sources.append(link);
+    }
+}
+
+int tst_Loader::loadGrid(const QStringList &sources)
+{
+    QQuickView view;
+    view.resize(960, 1200);
+
+    QQmlComponent component(view.engine());
+    component.setData(gridQml, QUrl());
+    QQuickItem *grid = qobject_cast<QQuickItem *>(component.create());
+    if (!grid) {
+        qWarning() << component.errors();
+        return -1;
+    }
+    grid->setParentItem(view.contentItem());
+    grid->setProperty("sources", sources);
+    view.show();
+
+    QList<NemoThumbnailItem *> items;
+    for (QQuickItem *child : grid->childItems()) {
+        if (NemoThumbnailItem *item = qobject_cast<NemoThumbnailItem *>(child)) {
+            items.append(item);
+        }
+    }
+
+    // Wait for every item to either show its thumbnail or fail.
+    QElapsedTimer timeout;
+    timeout.start();
+    int ready = 0;
+    while (!timeout.hasExpired(120000)) {
+        ready = 0;
+        for (NemoThumbnailItem *item : items) {
+            if (item->status() == NemoThumbnailItem::Ready || item->status() == NemoThumbnailItem::Error) {
+                ++ready;
+            }
+        }
+        if (ready == items.count()) {
+            break;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+
+    delete grid;
+
+    return ready;
+}
+
+void tst_Loader::grid_data()
+{
+    QTest::addColumn<bool>("warm");
+
+    QTest::newRow("cold") << false;
+    QTest::newRow("warm") << true;
+}
+
+void tst_Loader::grid()
+{
+    QFETCH(bool, warm);
+
+    if (warm) {
+        // Make sure every thumbnail has been generated and written.
+        QCOMPARE(loadGrid(m_sources), ItemCount);
+        QTest::qWait(1000);
+    } else {
+        // Drop anything generated by an earlier run, keeping the cache directory itself.
+        QDirIterator entries(m_cacheDirectory.path(), QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot);
+        while (entries.hasNext()) {
+            const QString path = entries.next();
+            if (entries.fileInfo().isDir()) {
+                QDir(path).removeRecursively();
+            } else {
+                QFile::remove(path);
+            }
+        }
+    }
+
+    int ready = 0;
+    QBENCHMARK_ONCE {
+        ready = loadGrid(m_sources);
+    }
+
+    QCOMPARE(ready, ItemCount);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run without a display or GPU.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    qputenv("QT_QUICK_BACKEND", "software");
+
+    QGuiApplication app(argc, argv);
+
+    tst_Loader test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_loader.moc"
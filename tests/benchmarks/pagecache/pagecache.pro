@@ -0,0 +1,8 @@
+include(../benchmarks.pri)
+
+TARGET = tst_pagecache
+QT += gui
+
+LIBS += -L$$OUT_PWD/../../../src/lib -lnemothumbnailer-qt$${QT_MAJOR_VERSION}
+
+SOURCES += tst_pagecache.cpp
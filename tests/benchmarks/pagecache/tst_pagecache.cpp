@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include <QtTest>
+#include <QImageReader>
+
+#include <nemothumbnailcache.h>
+
+#include "corpus.h"
+#include "nemothumbnailprotocol_p.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+class BenchmarkCache : public NemoThumbnailCache
+{
+public:
+    explicit BenchmarkCache(const QString &cachePath)
+        : NemoThumbnailCache(cachePath)
+    {
+    }
+
+    using NemoThumbnailCache::generateThumbnail;
+    using NemoThumbnailCache::waitForCacheFile;
+};
+
+// Drops the pages of a file from the page cache so every measurement starts cold.
+bool evict(const QString &path)
+{
+    const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    ::fdatasync(fd);
+    const bool evicted = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(fd);
+    return evicted;
+}
+
+// The number of bytes of a file in the page cache.
+qint64 residentBytes(const QString &path)
+{
+    const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    qint64 resident = -1;
+    struct stat status;
+    if (::fstat(fd, &status) == 0 && status.st_size > 0) {
+        void *data = ::mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            const long pageSize = ::sysconf(_SC_PAGESIZE);
+            QVector<unsigned char> pages((status.st_size + pageSize - 1) / pageSize);
+            if (::mincore(data, status.st_size, pages.data()) == 0) {
+                resident = 0;
+                for (unsigned char page : pages) {
+                    if (page & 1) {
+                        resident += pageSize;
+                    }
+                }
+            }
+            ::munmap(data, status.st_size);
+        }
+    }
+    ::close(fd);
+
+    return resident;
+}
+
+// The size of the page cache of the whole system, which also grows with anything else
+// happening at the same time so it is only reported for information.
+qint64 cachedBytes()
+{
+    QFile meminfo(QStringLiteral("/proc/meminfo"));
+    if (meminfo.open(QIODevice::ReadOnly)) {
+        while (!meminfo.atEnd()) {
+            const QList<QByteArray> fields = meminfo.readLine().simplified().split(' ');
+            if (fields.count() >= 2 && fields.first() == "Cached:") {
+                return fields.at(1).toLongLong() * 1024;
+            }
+        }
+    }
+    return -1;
+}
+
+}
+
+// Measures how much of a source remains in the page cache after its thumbnail was generated,
+// compared to simply decoding it.  The reported result is the resident size of the source.
+class tst_PageCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void decode_data();
+    void decode();
+    void generateThumbnail_data();
+    void generateThumbnail();
+
+private:
+    void addFileRows();
+    void report(const QString &path, qint64 cachedBefore);
+
+    QScopedPointer<QTemporaryDir> m_cacheDirectory;
+    QScopedPointer<BenchmarkCache> m_cache;
+};
+
+void tst_PageCache::initTestCase()
+{
+    qputenv("NEMO_THUMBNAILER_DAEMON", "0");
+    QVERIFY2(!corpusFiles().isEmpty(), "The benchmark corpus is missing");
+}
+
+void tst_PageCache::init()
+{
+    m_cacheDirectory.reset(new QTemporaryDir);
+    QVERIFY(m_cacheDirectory->isValid());
+    m_cache.reset(new BenchmarkCache(m_cacheDirectory->path()));
+}
+
+void tst_PageCache::cleanup()
+{
+    m_cache.reset();
+    m_cacheDirectory.reset();
+}
+
+void tst_PageCache::addFileRows()
+{
+    QTest::addColumn<QString>("path");
+
+    for (const QString &path : corpusFiles()) {
+        QTest::newRow(qPrintable(QFileInfo(path).fileName())) << path;
+    }
+}
+
+void tst_PageCache::report(const QString &path, qint64 cachedBefore)
+{
+    const qint64 resident = residentBytes(path);
+    QVERIFY(resident >= 0);
+
+    qInfo("%s: %lld of %lld bytes resident, page cache grew by %lld KiB",
+          qPrintable(QFileInfo(path).fileName()),
+          resident,
+          QFileInfo(path).size(),
+          (cachedBytes() - cachedBefore) / 1024);
+
+    QTest::setBenchmarkResult(resident, QTest::BytesAllocated);
+}
+
+void tst_PageCache::decode_data()
+{
+    addFileRows();
+}
+
+void tst_PageCache::decode()
+{
+    QFETCH(QString, path);
+
+    // The baseline, a plain QImageReader leaves the whole source in the page cache.
+    QVERIFY(evict(path));
+    const qint64 cachedBefore = cachedBytes();
+
+    QImageReader reader(path);
+    QVERIFY(!reader.read().isNull());
+
+    report(path, cachedBefore);
+}
+
+void tst_PageCache::generateThumbnail_data()
+{
+    addFileRows();
+}
+
+void tst_PageCache::generateThumbnail()
+{
+    QFETCH(QString, path);
+
+    QVERIFY(evict(path));
+    const qint64 cachedBefore = cachedBytes();
+
+    const QByteArray key = NemoThumbnailProtocol::sourceHash(path) + "-256";
+    const NemoThumbnailCache::ThumbnailData thumbnail
+            = m_cache->generateThumbnail(path, key, 256, true, QString());
+    QVERIFY(thumbnail.validImage());
+    if (thumbnail.validPath()) {
+        QVERIFY(BenchmarkCache::waitForCacheFile(thumbnail.path()));
+    }
+
+    report(path, cachedBefore);
+}
+
+QTEST_GUILESS_MAIN(tst_PageCache)
+
+#include "tst_pagecache.moc"
@@ -0,0 +1,568 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+// Replays a scroll trace against Thumbnail items in an offscreen window and reports how long
+// visible items took to display their thumbnails, how much work was wasted on items which were
+// scrolled away and how much memory was used.  Items with a high or normal priority are taken
+// to be visible, as views lower the priority of delegates outside the visible area.
+//
+// Traces are recorded from a running application by setting NEMO_THUMBNAILER_RECORD to the
+// path of the trace file, or generated by the tool from the benchmark corpus.
+
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QGuiApplication>
+#include <QQmlEngine>
+#include <QQuickView>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include <sys/resource.h>
+
+#include "corpus.h"
+#include "nemothumbnailitem.h"
+
+namespace {
+
+struct TraceEvent
+{
+    enum Type {
+        Create,
+        Change,
+        Destroy
+    };
+
+    qint64 time = 0;
+    Type type = Create;
+    QByteArray id;
+    int priority = NemoThumbnailItem::NormalPriority;
+    int fillMode = NemoThumbnailItem::PreserveAspectCrop;
+    QSize size;
+    QUrl source;
+    QString mimeType;
+};
+
+bool readTrace(const QString &path, QVector<TraceEvent> *events)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Cannot read trace" << path << file.errorString();
+        return false;
+    }
+
+    const QByteArray types[] = { "create", "change", "destroy" };
+
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        const QList<QByteArray> fields = line.split(' ');
+
+        TraceEvent event;
+        const int type = fields.count() >= 3
+                ? std::find(std::begin(types), std::end(types), fields.at(1)) - std::begin(types)
+                : 3;
+        if (type == 3 || (type != TraceEvent::Destroy && fields.count() != 9)) {
+            qWarning() << "Invalid trace event at" << path << "line" << lineNumber;
+            return false;
+        }
+
+        event.time = fields.at(0).toLongLong();
+        event.type = TraceEvent::Type(type);
+        event.id = fields.at(2);
+        if (event.type != TraceEvent::Destroy) {
+            event.priority = fields.at(3).toInt();
+            event.fillMode = fields.at(4).toInt();
+            event.size = QSize(fields.at(5).toInt(), fields.at(6).toInt());
+            if (fields.at(7) != "-")
+                event.source = QUrl::fromEncoded(fields.at(7));
+            if (fields.at(8) != "-")
+                event.mimeType = QString::fromUtf8(fields.at(8));
+        }
+        events->append(event);
+    }
+    return true;
+}
+
+bool writeTrace(const QString &path, const QVector<TraceEvent> &events)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << "Cannot write trace" << path << file.errorString();
+        return false;
+    }
+
+    const char * const types[] = { "create", "change", "destroy" };
+
+    QTextStream stream(&file);
+    stream << "# nemo-thumbnailer scroll trace 1\n";
+    for (const TraceEvent &event : events) {
+        stream << event.time << ' ' << types[event.type] << ' ' << event.id;
+        if (event.type != TraceEvent::Destroy) {
+            stream << ' ' << event.priority
+                   << ' ' << event.fillMode
+                   << ' ' << event.size.width()
+                   << ' ' << event.size.height()
+                   << ' ' << (event.source.isEmpty() ? QByteArray("-") : event.source.toEncoded())
+                   << ' ' << (event.mimeType.isEmpty() ? QStringLiteral("-") : event.mimeType);
+        }
+        stream << '\n';
+    }
+    return true;
+}
+
+struct ScrollOptions
+{
+    int columns = 4;
+    int rows = 6;
+    int bufferRows = 2;
+    qreal speed = 8;
+    int duration = 10000;
+    int size = 256;
+};
+
+// A grid view scrolling at a constant speed.  Delegates are created for the visible rows and
+// a number of rows either side of them, and have a high priority while they're visible and a
+// low priority otherwise.
+QVector<TraceEvent> scrollTrace(const QStringList &sources, const ScrollOptions &options)
+{
+    const int rowCount = sources.count() / options.columns;
+
+    QVector<TraceEvent> events;
+    int firstRow = 0;
+    int lastRow = 0;
+    QVector<bool> visible(rowCount, false);
+
+    const auto rowEvents = [&](qint64 time, int row, TraceEvent::Type type, bool rowVisible) {
+        for (int column = 0; column < options.columns; ++column) {
+            const int index = row * options.columns + column;
+
+            TraceEvent event;
+            event.time = time;
+            event.type = type;
+            event.id = QByteArray::number(index, 16);
+            event.priority = rowVisible ? NemoThumbnailItem::HighPriority : NemoThumbnailItem::LowPriority;
+            event.size = QSize(options.size, options.size);
+            event.source = QUrl::fromLocalFile(sources.at(index));
+            events.append(event);
+        }
+    };
+
+    for (qint64 time = 0; time <= options.duration; time += 16) {
+        const qreal position = options.speed * time / 1000;
+        const int first = qMax(0, int(position) - options.bufferRows);
+        const int last = qMin(rowCount, int(std::ceil(position)) + options.rows + options.bufferRows);
+
+        for (int row = firstRow; row < lastRow; ++row) {
+            if (row < first || row >= last)
+                rowEvents(time, row, TraceEvent::Destroy, false);
+        }
+        for (int row = first; row < last; ++row) {
+            const bool rowVisible = row + 1 > position && row < position + options.rows;
+            if (row < firstRow || row >= lastRow) {
+                rowEvents(time, row, TraceEvent::Create, rowVisible);
+            } else if (rowVisible != visible.at(row)) {
+                rowEvents(time, row, TraceEvent::Change, rowVisible);
+            }
+            visible[row] = rowVisible;
+        }
+
+        firstRow = first;
+        lastRow = last;
+    }
+
+    return events;
+}
+
+qreal percentile(QVector<qint64> values, int percent)
+{
+    if (values.isEmpty())
+        return 0;
+
+    const auto value = values.begin() + (values.count() - 1) * percent / 100;
+    std::nth_element(values.begin(), value, values.end());
+    return *value;
+}
+
+class Replay : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Replay(QQuickView *view);
+    ~Replay();
+
+    void run(const QVector<TraceEvent> &events, qreal rate, int timeout);
+    void report(QTextStream &out) const;
+
+private:
+    struct Item
+    {
+        NemoThumbnailItem *item = nullptr;
+        qint64 visibleSince = -1;
+        bool ready = false;
+        bool displayed = false;
+    };
+
+    void apply(const TraceEvent &event);
+    void update(Item *item, const TraceEvent &event);
+    void waitUntil(qint64 time);
+    bool pending() const;
+    void frameSwapped();
+
+    QQuickView *m_view;
+    QHash<QByteArray, Item *> m_items;
+    QElapsedTimer m_clock;
+    QVector<qint64> m_timeToFirstPixel;
+    qint64 m_duration = 0;
+    int m_eventCount = 0;
+    int m_itemCount = 0;
+    int m_abandoned = 0;
+    int m_failed = 0;
+};
+
+Replay::Replay(QQuickView *view)
+    : m_view(view)
+{
+    connect(view, &QQuickWindow::frameSwapped, this, &Replay::frameSwapped);
+}
+
+Replay::~Replay()
+{
+    for (Item *item : m_items) {
+        delete item->item;
+        delete item;
+    }
+}
+
+void Replay::run(const QVector<TraceEvent> &events, qreal rate, int timeout)
+{
+    if (NemoThumbnailLoader * const loader = qobject_cast<NemoThumbnailLoader *>(
+                qmlAttachedPropertiesObject<NemoThumbnailItem>(m_view))) {
+        loader->collectLatencies();
+    }
+
+    m_clock.start();
+
+    for (const TraceEvent &event : events) {
+        waitUntil(event.time / rate);
+        apply(event);
+        ++m_eventCount;
+    }
+
+    // Give the items still visible at the end of the trace a chance to show their thumbnails.
+    const qint64 deadline = m_clock.elapsed() + timeout;
+    while (pending() && m_clock.elapsed() < deadline)
+        waitUntil(m_clock.elapsed() + 10);
+
+    m_duration = m_clock.elapsed();
+}
+
+void Replay::waitUntil(qint64 time)
+{
+    const qint64 remaining = time - m_clock.elapsed();
+    if (remaining > 0) {
+        QEventLoop loop;
+        QTimer timer;
+        timer.setTimerType(Qt::PreciseTimer);
+        timer.setSingleShot(true);
+        connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
+        timer.start(int(remaining));
+        loop.exec();
+    } else {
+        QCoreApplication::processEvents();
+    }
+}
+
+void Replay::apply(const TraceEvent &event)
+{
+    Item *item = m_items.value(event.id);
+
+    switch (event.type) {
+    case TraceEvent::Create:
+        if (!item) {
+            item = new Item;
+            item->item = new NemoThumbnailItem;
+            item->item->setParentItem(m_view->contentItem());
+            m_items.insert(event.id, item);
+            ++m_itemCount;
+
+            NemoThumbnailItem * const thumbnail = item->item;
+            connect(thumbnail, &NemoThumbnailItem::statusChanged, this, [this, item, thumbnail]() {
+                if (thumbnail->status() == NemoThumbnailItem::Ready) {
+                    item->ready = true;
+                } else if (thumbnail->status() == NemoThumbnailItem::Error && item->visibleSince >= 0) {
+                    ++m_failed;
+                    item->visibleSince = -1;
+                }
+            });
+        }
+        update(item, event);
+        break;
+    case TraceEvent::Change:
+        if (item)
+            update(item, event);
+        break;
+    case TraceEvent::Destroy:
+        if (item) {
+            if (item->visibleSince >= 0 && !item->displayed)
+                ++m_abandoned;
+            m_items.remove(event.id);
+            delete item->item;
+            delete item;
+        }
+        break;
+    }
+}
+
+void Replay::update(Item *item, const TraceEvent &event)
+{
+    NemoThumbnailItem * const thumbnail = item->item;
+
+    const bool identityChanged = thumbnail->source() != event.source
+            || thumbnail->sourceSize() != event.size
+            || thumbnail->fillMode() != event.fillMode;
+    if (identityChanged) {
+        // The item shows a different thumbnail so starts waiting again.
+        if (item->visibleSince >= 0 && !item->displayed)
+            ++m_abandoned;
+        item->visibleSince = -1;
+        item->ready = false;
+        item->displayed = false;
+    }
+
+    const bool visible = event.priority != NemoThumbnailItem::LowPriority;
+    if (!visible) {
+        if (item->visibleSince >= 0 && !item->displayed)
+            ++m_abandoned;
+        item->visibleSince = -1;
+    } else if (item->visibleSince < 0 && !item->displayed) {
+        item->visibleSince = m_clock.elapsed();
+    }
+
+    thumbnail->setSize(event.size);
+    thumbnail->setPriority(NemoThumbnailItem::Priority(event.priority));
+    thumbnail->setFillMode(NemoThumbnailItem::FillMode(event.fillMode));
+    thumbnail->setMimeType(event.mimeType);
+    thumbnail->setSourceSize(event.size);
+    thumbnail->setSource(event.source);
+
+    // Render a frame even if nothing changed visually so a thumbnail which is already loaded
+    // is counted as shown.
+    m_view->update();
+}
+
+bool Replay::pending() const
+{
+    for (const Item *item : m_items) {
+        if (item->visibleSince >= 0 && !item->displayed)
+            return true;
+    }
+    return false;
+}
+
+void Replay::frameSwapped()
+{
+    // Items which became ready before the frame was rendered are now on screen.
+    const qint64 now = m_clock.elapsed();
+    for (Item *item : m_items) {
+        if (item->ready && item->visibleSince >= 0 && !item->displayed) {
+            item->displayed = true;
+            m_timeToFirstPixel.append(now - item->visibleSince);
+        }
+    }
+}
+
+void Replay::report(QTextStream &out) const
+{
+    out << "Replayed " << m_eventCount << " events for " << m_itemCount << " items in "
+        << m_duration << " ms\n";
+
+    out << "Time to first pixel of visible items (ms): count " << m_timeToFirstPixel.count()
+        << ", p50 " << percentile(m_timeToFirstPixel, 50)
+        << ", p90 " << percentile(m_timeToFirstPixel, 90)
+        << ", p99 " << percentile(m_timeToFirstPixel, 99)
+        << ", max " << percentile(m_timeToFirstPixel, 100) << '\n';
+    out << "Visible items which failed to load: " << m_failed << '\n';
+    out << "Items scrolled away before their thumbnail was shown: " << m_abandoned << '\n';
+
+    NemoThumbnailLoader * const loader = qobject_cast<NemoThumbnailLoader *>(
+                qmlAttachedPropertiesObject<NemoThumbnailItem>(m_view, false));
+    if (loader) {
+        const NemoThumbnailLoader::Statistics statistics = loader->statistics();
+
+        out << "Thumbnails loaded after their items were destroyed: " << statistics.wastedLoads << '\n';
+        out << "Memory hit rate: " << statistics.memoryHitRate()
+            << ", disk hit rate: " << statistics.diskHitRate() << '\n';
+
+        int generations = 0;
+        for (int count : statistics.generations)
+            generations += count;
+        out << "Thumbnails generated: " << generations << '\n';
+
+        out << "Stage latencies p50/p95 (ms):";
+        for (int stage = 0; stage < NemoThumbnailTrace::StageCount; ++stage) {
+            out << ' ' << (stage == NemoThumbnailTrace::Queued
+                            ? "total"
+                            : NemoThumbnailTrace::stageName(NemoThumbnailTrace::Stage(stage)))
+                << ' ' << statistics.stageP50[stage] << '/' << statistics.stageP95[stage];
+        }
+        out << '\n';
+
+        out << "Peak texture cost: " << statistics.peakCost << " pixels\n";
+    }
+
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) == 0)
+        out << "Peak resident memory: " << usage.ru_maxrss << " KiB\n";
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    // Run without a display or GPU.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    qputenv("QT_QUICK_BACKEND", "software");
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+                "Replays a scroll trace recorded with NEMO_THUMBNAILER_RECORD, or a generated one, "
+                "against the thumbnail loader."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("trace"), QStringLiteral("The trace to replay."), QStringLiteral("[trace]"));
+
+    const QCommandLineOption scrollOption(QStringLiteral("scroll"),
+                QStringLiteral("Replay a grid scrolling through the benchmark corpus instead of a trace."));
+    const QCommandLineOption columnsOption(QStringLiteral("columns"),
+                QStringLiteral("Columns in the scrolled grid."), QStringLiteral("count"), QStringLiteral("4"));
+    const QCommandLineOption rowsOption(QStringLiteral("rows"),
+                QStringLiteral("Visible rows in the scrolled grid."), QStringLiteral("count"), QStringLiteral("6"));
+    const QCommandLineOption bufferOption(QStringLiteral("buffer"),
+                QStringLiteral("Rows created either side of the visible rows."), QStringLiteral("count"), QStringLiteral("2"));
+    const QCommandLineOption speedOption(QStringLiteral("speed"),
+                QStringLiteral("Rows scrolled per second."), QStringLiteral("rows"), QStringLiteral("8"));
+    const QCommandLineOption durationOption(QStringLiteral("duration"),
+                QStringLiteral("Milliseconds to scroll for."), QStringLiteral("ms"), QStringLiteral("10000"));
+    const QCommandLineOption sizeOption(QStringLiteral("size"),
+                QStringLiteral("Source size of the thumbnails."), QStringLiteral("pixels"), QStringLiteral("256"));
+    const QCommandLineOption saveOption(QStringLiteral("save"),
+                QStringLiteral("Write the generated trace to a file."), QStringLiteral("path"));
+    const QCommandLineOption rateOption(QStringLiteral("rate"),
+                QStringLiteral("Playback speed relative to the trace."), QStringLiteral("factor"), QStringLiteral("1"));
+    const QCommandLineOption cacheOption(QStringLiteral("cache"),
+                QStringLiteral("Use an existing cache home instead of an empty one."), QStringLiteral("path"));
+    const QCommandLineOption timeoutOption(QStringLiteral("timeout"),
+                QStringLiteral("Milliseconds to wait for visible items after the trace ends."),
+                QStringLiteral("ms"), QStringLiteral("30000"));
+    parser.addOptions({
+        scrollOption, columnsOption, rowsOption, bufferOption, speedOption, durationOption,
+        sizeOption, saveOption, rateOption, cacheOption, timeoutOption
+    });
+    parser.process(app);
+
+    // A fresh cache home unless asked otherwise, thumbnails are generated in process.
+    QTemporaryDir cacheDirectory;
+    qputenv("XDG_CACHE_HOME", QFile::encodeName(parser.isSet(cacheOption)
+                ? parser.value(cacheOption)
+                : cacheDirectory.path()));
+    qputenv("NEMO_THUMBNAILER_DAEMON", "0");
+
+    qmlRegisterType<NemoThumbnailItem>("Nemo.Thumbnailer", 1, 0, "Thumbnail");
+
+    QVector<TraceEvent> events;
+    QTemporaryDir sourceDirectory;
+    if (parser.isSet(scrollOption)) {
+        ScrollOptions options;
+        options.columns = qMax(1, parser.value(columnsOption).toInt());
+        options.rows = qMax(1, parser.value(rowsOption).toInt());
+        options.bufferRows = qMax(0, parser.value(bufferOption).toInt());
+        options.speed = parser.value(speedOption).toDouble();
+        options.duration = parser.value(durationOption).toInt();
+        options.size = parser.value(sizeOption).toInt();
+
+        const QStringList corpus = corpusFiles();
+        if (corpus.isEmpty()) {
+            qWarning() << "The benchmark corpus is missing";
+            return EXIT_FAILURE;
+        }
+
+        // Links to the corpus give every item its own source and so its own cache entry.
+        const int rowCount = int(std::ceil(options.speed * options.duration / 1000))
+                + options.rows + options.bufferRows + 1;
+        QStringList sources;
+        for (int i = 0; i < rowCount * options.columns; ++i) {
+            const QString source = corpus.at(i % corpus.count());
+            const QString link = sourceDirectory.filePath(
+                        QStringLiteral("%1-%2").arg(i).arg(QFileInfo(source).fileName()));
+            QFile::link(source, link);
+            sources.append(link);
+        }
+
+        events = scrollTrace(sources, options);
+
+        if (parser.isSet(saveOption) && !writeTrace(parser.value(saveOption), events))
+            return EXIT_FAILURE;
+    } else if (parser.positionalArguments().count() == 1) {
+        if (!readTrace(parser.positionalArguments().first(), &events))
+            return EXIT_FAILURE;
+    } else {
+        parser.showHelp(EXIT_FAILURE);
+    }
+
+    QQuickView view;
+    view.resize(960, 1200);
+    view.show();
+
+    QTextStream out(stdout);
+    {
+        Replay replay(&view);
+        replay.run(events, qMax(0.01, parser.value(rateOption).toDouble()), parser.value(timeoutOption).toInt());
+        replay.report(out);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+#include "main.moc"
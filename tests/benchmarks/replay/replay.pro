@@ -0,0 +1,21 @@
+include(../benchmarks.pri)
+
+TARGET = thumbnail-replay
+QT += qml quick
+QT -= testlib
+
+PLUGIN_PATH = ../../../src/plugin
+
+INCLUDEPATH += $$PLUGIN_PATH
+LIBS += -L$$OUT_PWD/../../../src/lib -lnemothumbnailer-qt$${QT_MAJOR_VERSION}
+
+SOURCES += \
+    main.cpp \
+    $$PLUGIN_PATH/nemothumbnailitem.cpp \
+    $$PLUGIN_PATH/nemothumbnailrecorder.cpp \
+    $$PLUGIN_PATH/nemothumbnailrequestcache.cpp
+HEADERS += \
+    $$PLUGIN_PATH/linkedlist.h \
+    $$PLUGIN_PATH/nemothumbnailitem.h \
+    $$PLUGIN_PATH/nemothumbnailrecorder.h \
+    $$PLUGIN_PATH/nemothumbnailrequestcache.h
@@ -0,0 +1,16 @@
+include(../benchmarks.pri)
+
+TARGET = tst_scaler
+CONFIG += simd
+QT += core-private gui
+
+LIB_PATH = ../../../src/lib
+
+SOURCES += \
+    tst_scaler.cpp \
+    $$LIB_PATH/nemoimagescaler.cpp
+HEADERS += $$LIB_PATH/nemoimagescaler_p.h
+
+SSE2_SOURCES += $$LIB_PATH/nemoimagescaler_sse2.cpp
+AVX2_SOURCES += $$LIB_PATH/nemoimagescaler_avx2.cpp
+NEON_SOURCES += $$LIB_PATH/nemoimagescaler_neon.cpp
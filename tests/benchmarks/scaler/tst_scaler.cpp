@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include <QtTest>
+#include <QImage>
+
+#include "corpus.h"
+#include "nemoimagescaler_p.h"
+
+// Compares the area averaging scaler against the Qt scaling it replaced.
+class tst_Scaler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void scaled_data();
+    void scaled();
+    void scaleImage_data();
+    void scaleImage();
+
+private:
+    QImage m_photo;
+};
+
+namespace {
+
+enum Method {
+    AreaAveraging,
+    QtFast,
+    QtSmooth
+};
+
+}
+
+void tst_Scaler::initTestCase()
+{
+    m_photo = QImage(corpusPath() + QLatin1String("/photo-4032x3024.jpg"));
+    QVERIFY2(!m_photo.isNull(), "The benchmark corpus is missing");
+}
+
+void tst_Scaler::scaled_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<QSize>("sourceSize");
+    QTest::addColumn<QSize>("targetSize");
+    QTest::addColumn<int>("method");
+
+    const struct {
+        const char *name;
+        QImage::Format format;
+    } formats[] = {
+        { "RGB32", QImage::Format_RGB32 },
+        { "RGBX8888", QImage::Format_RGBX8888 },
+        { "ARGB32_Premultiplied", QImage::Format_ARGB32_Premultiplied },
+        { "RGBA8888_Premultiplied", QImage::Format_RGBA8888_Premultiplied }
+    };
+    const QSize sizes[][2] = {
+        { QSize(4032, 3024), QSize(512, 384) },
+        { QSize(1920, 1080), QSize(256, 144) },
+        { QSize(1024, 768), QSize(128, 96) }
+    };
+    const struct {
+        const char *name;
+        Method method;
+    } methods[] = {
+        { "area", AreaAveraging },
+        { "qt-fast", QtFast },
+        { "qt-smooth", QtSmooth }
+    };
+
+    for (const auto &format : formats) {
+        for (const auto &size : sizes) {
+            for (const auto &method : methods) {
+                QTest::addRow("%s %dx%d->%dx%d %s", format.name,
+                              size[0].width(), size[0].height(), size[1].width(), size[1].height(),
+                              method.name)
+                        << int(format.format) << size[0] << size[1] << int(method.method);
+            }
+        }
+    }
+}
+
+void tst_Scaler::scaled()
+{
+    QFETCH(int, format);
+    QFETCH(QSize, sourceSize);
+    QFETCH(QSize, targetSize);
+    QFETCH(int, method);
+
+    const QImage source = m_photo.scaled(sourceSize).convertToFormat(QImage::Format(format));
+
+    QImage result;
+    QBENCHMARK {
+        switch (method) {
+        case AreaAveraging:
+            result = NemoImageScaler::scaled(source, targetSize);
+            break;
+        case QtFast:
+            result = source.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+            break;
+        case QtSmooth:
+            result = source.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            break;
+        }
+    }
+
+    QCOMPARE(result.size(), targetSize);
+}
+
+void tst_Scaler::scaleImage_data()
+{
+    QTest::addColumn<QSize>("requestedSize");
+    QTest::addColumn<bool>("crop");
+    QTest::addColumn<bool>("smooth");
+
+    QTest::newRow("fit 512 fast") << QSize(512, 512) << false << false;
+    QTest::newRow("fit 512 smooth") << QSize(512, 512) << false << true;
+    QTest::newRow("crop 256 fast") << QSize(256, 256) << true << false;
+    QTest::newRow("crop 256 smooth") << QSize(256, 256) << true << true;
+}
+
+void tst_Scaler::scaleImage()
+{
+    QFETCH(QSize, requestedSize);
+    QFETCH(bool, crop);
+    QFETCH(bool, smooth);
+
+    const QImage source = m_photo.convertToFormat(QImage::Format_RGBX8888);
+
+    QImage result;
+    QBENCHMARK {
+        result = NemoImageScaler::scaleImage(
+                    source, requestedSize, crop, smooth ? Qt::SmoothTransformation : Qt::FastTransformation);
+    }
+
+    QVERIFY(!result.isNull());
+}
+
+QTEST_GUILESS_MAIN(tst_Scaler)
+
+#include "tst_scaler.moc"
@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+SUBDIRS = auto benchmarks
+
+tests_xml.files = tests.xml
+tests_xml.path = /opt/tests/nemo-qml-plugin-thumbnailer-qt5
+INSTALLS += tests_xml
+
+OTHER_FILES += tests.xml
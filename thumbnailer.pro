@@ -1,5 +1,7 @@
 TEMPLATE = subdirs
-SUBDIRS = src doc
+SUBDIRS = src doc tests
+
+tests.depends = src
 
 OTHER_FILES += \
     rpm/nemo-qml-plugin-thumbnailer-qt5.spec